@@ -87,8 +87,8 @@ bool HelloWorld::init()
     _gameController = std::make_unique<GameController>();
     if (_gameController->init(this))
     {
-        // 开始游戏
-        _gameController->startGame(1);
+        // 恢复上次未完成的对局，没有时从第1关开始
+        _gameController->restoreSession(1);
     }
 
     return true;
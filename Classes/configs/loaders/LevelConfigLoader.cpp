@@ -6,26 +6,344 @@
  * 
  * 关卡配置加载器的具体实现
  * 负责从各种数据源加载游戏关卡的配置信息
- * 支持JSON格式配置文件和硬编码的测试关卡
+ * 支持JSON格式配置文件（RapidJSON SAX原地解析）和硬编码的测试关卡
  */
 
 #include "LevelConfigLoader.h"
+#include "LevelPackReader.h"
 #include "../models/LevelConfig.h"
+#include "json/reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 USING_NS_CC;
 
+namespace
+{
+    const char* const kLevelPackPath = "levels/levels.pack";      // 默认关卡包（tools/LevelPackCompiler的输出）
+    
+    /**
+     * @class LevelJsonHandler
+     * @brief 关卡JSON的SAX处理器
+     *
+     * 按“根对象 -> Playfield/Stack数组 -> 卡牌对象 -> Position对象”的层次维护状态，
+     * 每张卡牌读完后直接追加到对应数组；未知的键连同其值（可以是任意嵌套结构）整体跳过。
+     * 任何处理函数返回false时RapidJSON立即停止解析
+     */
+    class LevelJsonHandler
+    {
+    public:
+        /**
+         * @param capacity 两个数组合计卡牌数的上限估计，进入数组时按剩余额度预留容量
+         */
+        explicit LevelJsonHandler(size_t capacity)
+            : _capacity(capacity)
+            , _state(LS_ROOT)
+            , _key(LK_NONE)
+            , _cards(nullptr)
+            , _skipDepth(0)
+            , _face(-1)
+            , _suit(-1)
+            , _hasPosition(false)
+        {
+        }
+        
+        std::vector<LevelConfig::CardConfig>& getPlayfield() { return _playfield; }
+        std::vector<LevelConfig::CardConfig>& getStack() { return _stack; }
+        
+        // 根对象是否已完整读完
+        bool isComplete() const { return _state == LS_DONE; }
+        
+        bool Null() { return skipValue(); }
+        bool Bool(bool) { return skipValue(); }
+        bool Int(int value) { return number(value, true); }
+        bool Uint(unsigned value) { return number(value, true); }
+        bool Int64(int64_t value) { return number(static_cast<double>(value), true); }
+        bool Uint64(uint64_t value) { return number(static_cast<double>(value), true); }
+        bool Double(double value) { return number(value, value == std::floor(value)); }
+        bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }
+        bool String(const char*, rapidjson::SizeType, bool) { return skipValue(); }
+        
+        bool Key(const char* str, rapidjson::SizeType length, bool)
+        {
+            if (_skipDepth > 0)
+                return true;
+            
+            switch (_state)
+            {
+                case LS_TOP:
+                    _key = keyIs(str, length, "Playfield") ? LK_PLAYFIELD
+                         : keyIs(str, length, "Stack") ? LK_STACK : LK_SKIP;
+                    return true;
+                case LS_CARD:
+                    _key = keyIs(str, length, "CardFace") ? LK_FACE
+                         : keyIs(str, length, "CardSuit") ? LK_SUIT
+                         : keyIs(str, length, "Position") ? LK_POSITION : LK_SKIP;
+                    return true;
+                case LS_POSITION:
+                    _key = keyIs(str, length, "x") ? LK_X
+                         : keyIs(str, length, "y") ? LK_Y : LK_SKIP;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        
+        bool StartObject()
+        {
+            if (beginSkip())
+                return true;
+            
+            switch (_state)
+            {
+                case LS_ROOT:
+                    _state = LS_TOP;
+                    return true;
+                case LS_CARDS:
+                    _state = LS_CARD;
+                    _face = -1;
+                    _suit = -1;
+                    _hasPosition = false;
+                    _position = Vec2::ZERO;
+                    return true;
+                case LS_CARD:
+                    if (_key != LK_POSITION)
+                        return false;
+                    _state = LS_POSITION;
+                    _key = LK_NONE;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        
+        bool EndObject(rapidjson::SizeType)
+        {
+            if (endSkip())
+                return true;
+            
+            switch (_state)
+            {
+                case LS_TOP:
+                    _state = LS_DONE;
+                    return true;
+                case LS_POSITION:
+                    _state = LS_CARD;
+                    _hasPosition = true;
+                    _key = LK_NONE;
+                    return true;
+                case LS_CARD:
+                    _state = LS_CARDS;
+                    return finishCard();
+                default:
+                    return false;
+            }
+        }
+        
+        bool StartArray()
+        {
+            if (beginSkip())
+                return true;
+            
+            if (_state != LS_TOP || (_key != LK_PLAYFIELD && _key != LK_STACK))
+                return false;
+            
+            // 另一个数组已读到的卡牌各占一个'{'，两个数组合计只预留一份估计
+            const std::vector<LevelConfig::CardConfig>& other = _key == LK_PLAYFIELD ? _stack : _playfield;
+            _cards = _key == LK_PLAYFIELD ? &_playfield : &_stack;
+            _cards->reserve(_capacity - std::min(_capacity, other.size()));
+            _state = LS_CARDS;
+            return true;
+        }
+        
+        bool EndArray(rapidjson::SizeType)
+        {
+            if (endSkip())
+                return true;
+            
+            if (_state != LS_CARDS)
+                return false;
+            
+            _state = LS_TOP;
+            _key = LK_NONE;
+            return true;
+        }
+    
+    private:
+        // 解析位置
+        enum State
+        {
+            LS_ROOT,            // 尚未进入根对象
+            LS_TOP,             // 根对象中
+            LS_CARDS,           // 卡牌数组中
+            LS_CARD,            // 卡牌对象中
+            LS_POSITION,        // Position对象中
+            LS_DONE             // 根对象已结束
+        };
+        
+        // 最近读到的键
+        enum KeyId
+        {
+            LK_NONE,
+            LK_SKIP,            // 未知的键，其值整体跳过
+            LK_PLAYFIELD,
+            LK_STACK,
+            LK_FACE,
+            LK_SUIT,
+            LK_POSITION,
+            LK_X,
+            LK_Y
+        };
+        
+        static bool keyIs(const char* str, rapidjson::SizeType length, const char* name)
+        {
+            return std::strlen(name) == length && std::memcmp(str, name, length) == 0;
+        }
+        
+        // 未知键的值为对象或数组时进入跳过模式
+        bool beginSkip()
+        {
+            if (_skipDepth > 0 || _key == LK_SKIP)
+            {
+                ++_skipDepth;
+                return true;
+            }
+            return false;
+        }
+        
+        bool endSkip()
+        {
+            if (_skipDepth == 0)
+                return false;
+            
+            if (--_skipDepth == 0)
+            {
+                _key = LK_NONE;
+            }
+            return true;
+        }
+        
+        // 非数值的标量只能出现在被跳过的位置
+        bool skipValue()
+        {
+            if (_skipDepth > 0)
+                return true;
+            if (_key != LK_SKIP)
+                return false;
+            
+            _key = LK_NONE;
+            return true;
+        }
+        
+        bool number(double value, bool integral)
+        {
+            if (_skipDepth > 0 || _key == LK_SKIP)
+                return skipValue();
+            
+            KeyId key = _key;
+            _key = LK_NONE;
+            switch (key)
+            {
+                case LK_FACE:
+                    if (!integral || value < CFT_ACE || value >= CFT_NUM_CARD_FACE_TYPES)
+                        return false;
+                    _face = static_cast<int>(value);
+                    return true;
+                case LK_SUIT:
+                    if (!integral || value < CST_CLUBS || value >= CST_NUM_CARD_SUIT_TYPES)
+                        return false;
+                    _suit = static_cast<int>(value);
+                    return true;
+                case LK_X:
+                    _position.x = static_cast<float>(value);
+                    return true;
+                case LK_Y:
+                    _position.y = static_cast<float>(value);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        
+        // 卡牌对象结束：点数花色必填，游戏区卡牌还必须有位置
+        bool finishCard()
+        {
+            if (_face < 0 || _suit < 0 || (_cards == &_playfield && !_hasPosition))
+                return false;
+            
+            _cards->push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(_face), static_cast<CardSuitType>(_suit), _position));
+            return true;
+        }
+        
+        size_t _capacity;                               // 两个数组合计的卡牌数上限估计
+        State _state;
+        KeyId _key;
+        std::vector<LevelConfig::CardConfig>* _cards;   // 当前数组
+        int _skipDepth;                                 // 正在跳过的对象/数组嵌套深度
+        
+        // 当前卡牌
+        int _face;
+        int _suit;
+        Vec2 _position;
+        bool _hasPosition;
+        
+        std::vector<LevelConfig::CardConfig> _playfield;
+        std::vector<LevelConfig::CardConfig> _stack;
+    };
+}
+
 /**
  * @brief 根据关卡ID加载关卡配置
  * @param levelId 关卡唯一标识符
  * @return 加载的关卡配置对象，失败时返回nullptr
  * 
- * 当前实现返回默认测试关卡配置
- * TODO: 后续可扩展支持多关卡配置文件
+ * 依次查找：
+ * - 关卡包levels/levels.pack（首次调用时映射，之后按ID O(1)定位，不解析）
+ * - 单独的关卡文件levels/level_<levelId>.json，读入的字符串直接作为原地解析的缓冲区
+ * - 都没有时使用默认测试关卡
  */
 LevelConfig* LevelConfigLoader::loadLevelConfig(int levelId)
 {
-    // 目前加载默认测试关卡，后续可根据levelId加载不同关卡
-    return loadDefaultTestLevel();
+    static LevelPackReader* levelPack = openLevelPack();
+    if (levelPack && levelPack->hasLevel(levelId))
+    {
+        return levelPack->createLevelConfig(levelId);
+    }
+    
+    std::string path = StringUtils::format("levels/level_%d.json", levelId);
+    if (!FileUtils::getInstance()->isFileExist(path))
+    {
+        return loadDefaultTestLevel();
+    }
+    
+    std::string json = FileUtils::getInstance()->getStringFromFile(path);
+    LevelConfig* config = loadFromJsonInsitu(&json[0]);
+    if (!config)
+    {
+        CCLOG("Invalid level file %s", path.c_str());
+    }
+    return config;
+}
+
+/**
+ * @brief 打开默认关卡包
+ * @return 关卡包读取器，文件不存在或无效时返回nullptr
+ * 
+ * 读取器在整个进程生命周期内保持映射，不释放
+ */
+LevelPackReader* LevelConfigLoader::openLevelPack()
+{
+    if (!FileUtils::getInstance()->isFileExist(kLevelPackPath))
+        return nullptr;
+    
+    LevelPackReader* reader = new LevelPackReader();
+    if (!reader->open(kLevelPackPath))
+    {
+        delete reader;
+        return nullptr;
+    }
+    return reader;
 }
 
 /**
@@ -33,14 +351,44 @@ LevelConfig* LevelConfigLoader::loadLevelConfig(int levelId)
  * @param jsonString 包含关卡数据的JSON格式字符串
  * @return 解析生成的关卡配置对象，失败时返回nullptr
  * 
- * TODO: 实现完整的JSON解析逻辑
- * 当前版本返回默认测试关卡作为占位实现
+ * 输入是只读的，复制到临时缓冲区后原地解析
  */
 LevelConfig* LevelConfigLoader::loadFromJsonString(const std::string& jsonString)
 {
-    // TODO: 实现JSON解析功能
-    // 目前返回默认测试关卡
-    return loadDefaultTestLevel();
+    std::string buffer(jsonString);
+    return loadFromJsonInsitu(&buffer[0]);
+}
+
+/**
+ * @brief 在可写缓冲区上原地解析关卡配置
+ * @param json 以'\0'结尾的JSON缓冲区，解析过程中被改写
+ * @return 解析生成的关卡配置对象，失败时返回nullptr
+ * 
+ * 卡牌数组的容量按缓冲区中'{'的个数预留：每张卡牌至少对应一个对象，
+ * 一次线性扫描即可得到上限，解析过程中不再扩容
+ */
+LevelConfig* LevelConfigLoader::loadFromJsonInsitu(char* json)
+{
+    if (!json)
+        return nullptr;
+    
+    size_t length = std::strlen(json);
+    LevelJsonHandler handler(static_cast<size_t>(std::count(json, json + length, '{')));
+    
+    rapidjson::InsituStringStream stream(json);
+    rapidjson::Reader reader;
+    rapidjson::ParseResult result = reader.Parse<rapidjson::kParseInsituFlag | rapidjson::kParseStopWhenDoneFlag>(stream, handler);
+    if (!result || !handler.isComplete())
+    {
+        CCLOG("Level JSON parse failed at offset %u (error %d)",
+              static_cast<unsigned>(result.Offset()), static_cast<int>(result.Code()));
+        return nullptr;
+    }
+    
+    LevelConfig* config = new LevelConfig();
+    config->setPlayfieldCards(std::move(handler.getPlayfield()));
+    config->setStackCards(std::move(handler.getStack()));
+    return config;
 }
 
 /**
@@ -72,7 +420,7 @@ LevelConfig* LevelConfigLoader::loadDefaultTestLevel()
     playfieldCards.push_back(LevelConfig::CardConfig(CFT_TWO, CST_SPADES, Vec2(800, 1300)));     // 2♠ - 右上中
     playfieldCards.push_back(LevelConfig::CardConfig(CFT_ACE, CST_SPADES, Vec2(750, 1100)));     // A♠ - 右中下
     
-    config->setPlayfieldCards(playfieldCards);
+    config->setPlayfieldCards(std::move(playfieldCards));
     
     // 创建备牌堆卡牌配置（下方右侧区域）
     std::vector<LevelConfig::CardConfig> stackCards;
@@ -80,39 +428,7 @@ LevelConfig* LevelConfigLoader::loadDefaultTestLevel()
     stackCards.push_back(LevelConfig::CardConfig(CFT_ACE, CST_HEARTS, Vec2(0, 0)));    // A♥ - 备牌1
     stackCards.push_back(LevelConfig::CardConfig(CFT_THREE, CST_CLUBS, Vec2(0, 0)));   // 3♣ - 备牌2
     
-    config->setStackCards(stackCards);
+    config->setStackCards(std::move(stackCards));
     
     return config;
 }
-
-/**
- * @brief 将整数值转换为卡牌点数枚举
- * @param faceValue 整数形式的点数值
- * @return 对应的卡牌点数枚举，无效值时返回CFT_ACE
- * 
- * 用于从配置文件或外部数据源解析卡牌点数
- */
-CardFaceType LevelConfigLoader::intToCardFace(int faceValue)
-{
-    if (faceValue >= 0 && faceValue < CFT_NUM_CARD_FACE_TYPES)
-    {
-        return static_cast<CardFaceType>(faceValue);
-    }
-    return CFT_ACE;  // 默认返回A作为安全值
-}
-
-/**
- * @brief 将整数值转换为卡牌花色枚举
- * @param suitValue 整数形式的花色值
- * @return 对应的卡牌花色枚举，无效值时返回CST_CLUBS
- * 
- * 用于从配置文件或外部数据源解析卡牌花色
- */
-CardSuitType LevelConfigLoader::intToCardSuit(int suitValue)
-{
-    if (suitValue >= 0 && suitValue < CST_NUM_CARD_SUIT_TYPES)
-    {
-        return static_cast<CardSuitType>(suitValue);
-    }
-    return CST_CLUBS;  // 默认返回草花作为安全值
-}
@@ -3,28 +3,49 @@
 
 #include "cocos2d.h"
 #include "../models/LevelConfig.h"
+#include <string>
+
+class LevelPackReader;
 
 /**
  * 关卡配置加载器
  * 负责从JSON文件或数据中加载关卡配置
+ *
+ * 关卡JSON格式（与tools/LevelSolver相同，点数和花色为CardFaceType/CardSuitType的取值）：
+ * { "Playfield": [ { "CardFace": 11, "CardSuit": 0, "Position": { "x": 400, "y": 1500 } }, ... ],
+ *   "Stack": [ { "CardFace": 3, "CardSuit": 0 }, ... ] }
+ * 未知的键被忽略；游戏区卡牌必须有Position，手牌堆卡牌的Position可省略
+ *
+ * 解析使用RapidJSON的SAX接口在原缓冲区上原地解析（不建立DOM），
+ * 卡牌直接写入预留好容量的CardConfig数组，再整体移动进LevelConfig
  */
 class LevelConfigLoader
 {
 public:
     /**
      * 加载关卡配置
+     * 优先从关卡包levels/levels.pack（tools/LevelPackCompiler的输出）读取，
+     * 其次读取levels/level_<levelId>.json，都没有时返回默认测试关卡
      * @param levelId 关卡ID
-     * @return 加载的关卡配置，失败返回nullptr
+     * @return 加载的关卡配置，文件内容无效时返回nullptr
      */
     static LevelConfig* loadLevelConfig(int levelId);
     
     /**
      * 从JSON字符串加载关卡配置
+     * 字符串先复制一份再原地解析，能修改输入缓冲区时使用loadFromJsonInsitu
      * @param jsonString JSON配置字符串
      * @return 加载的关卡配置，失败返回nullptr
      */
     static LevelConfig* loadFromJsonString(const std::string& jsonString);
     
+    /**
+     * 在输入缓冲区上原地解析关卡配置，不复制输入
+     * @param json 以'\0'结尾的可写JSON缓冲区，解析后内容被改写
+     * @return 加载的关卡配置，失败返回nullptr
+     */
+    static LevelConfig* loadFromJsonInsitu(char* json);
+    
     /**
      * 加载默认测试关卡
      * @return 默认测试关卡配置
@@ -33,25 +54,10 @@ public:
 
 private:
     /**
-     * Parse card configuration from JSON value
-     * @param cardValue JSON value
-     * @return Parsed card configuration
-     */
-    // static LevelConfig::CardConfig parseCardConfig(const rapidjson::Value& cardValue);
-    
-    /**
-     * 将数值转换为卡牌点数
-     * @param faceValue 点数值
-     * @return 卡牌点数枚举
-     */
-    static CardFaceType intToCardFace(int faceValue);
-    
-    /**
-     * 将数值转换为卡牌花色
-     * @param suitValue 花色值
-     * @return 卡牌花色枚举
+     * 打开默认关卡包
+     * @return 关卡包读取器，不存在或无效时返回nullptr
      */
-    static CardSuitType intToCardSuit(int suitValue);
+    static LevelPackReader* openLevelPack();
 };
 
 #endif // __LEVEL_CONFIG_LOADER_H__
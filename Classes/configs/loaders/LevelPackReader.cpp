@@ -0,0 +1,254 @@
+#include "LevelPackReader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+USING_NS_CC;
+
+using namespace LevelPackFormat;
+
+LevelPackReader::LevelPackReader()
+    : _data(nullptr)
+    , _size(0)
+    , _mapped(false)
+#ifdef _WIN32
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mappingHandle(nullptr)
+#else
+    , _fd(-1)
+#endif
+{
+}
+
+LevelPackReader::~LevelPackReader()
+{
+    close();
+}
+
+bool LevelPackReader::open(const std::string& path)
+{
+    close();
+    
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
+    if (fullPath.empty())
+        return false;
+    
+    if (!mapFile(fullPath))
+    {
+        // 无法映射（文件在安装包内等），整体读入内存
+        if (FileUtils::getInstance()->getContents(fullPath, &_buffer) != FileUtils::Status::OK || _buffer.empty())
+        {
+            close();
+            return false;
+        }
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+    
+    if (!validate())
+    {
+        CCLOG("LevelPackReader: invalid level pack %s", fullPath.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LevelPackReader::close()
+{
+    if (_mapped)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mappingHandle);
+        _mappingHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+        _mapped = false;
+    }
+
+#ifdef _WIN32
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+#endif
+
+    std::vector<uint8_t>().swap(_buffer);
+    _data = nullptr;
+    _size = 0;
+}
+
+size_t LevelPackReader::getLevelCount() const
+{
+    return _data ? header()->levelCount : 0;
+}
+
+bool LevelPackReader::hasLevel(int levelId) const
+{
+    return findEntry(levelId) != nullptr;
+}
+
+size_t LevelPackReader::getPlayfieldCount(int levelId) const
+{
+    const LevelEntry* entry = findEntry(levelId);
+    return entry ? entry->playfieldCount : 0;
+}
+
+size_t LevelPackReader::getStackCount(int levelId) const
+{
+    const LevelEntry* entry = findEntry(levelId);
+    return entry ? entry->stackCount : 0;
+}
+
+const CardRecord* LevelPackReader::getCards(int levelId) const
+{
+    const LevelEntry* entry = findEntry(levelId);
+    return entry ? reinterpret_cast<const CardRecord*>(_data + entry->offset) : nullptr;
+}
+
+LevelConfig* LevelPackReader::createLevelConfig(int levelId) const
+{
+    const LevelEntry* entry = findEntry(levelId);
+    if (!entry)
+        return nullptr;
+    
+    const CardRecord* records = reinterpret_cast<const CardRecord*>(_data + entry->offset);
+    
+    std::vector<LevelConfig::CardConfig> playfield(entry->playfieldCount);
+    for (size_t i = 0; i < playfield.size(); ++i)
+    {
+        playfield[i].card = CardCode::fromBits(records[i].code);
+        playfield[i].position = Vec2(records[i].x, records[i].y);
+    }
+    records += entry->playfieldCount;
+    
+    std::vector<LevelConfig::CardConfig> stack(entry->stackCount);
+    for (size_t i = 0; i < stack.size(); ++i)
+    {
+        stack[i].card = CardCode::fromBits(records[i].code);
+        stack[i].position = Vec2(records[i].x, records[i].y);
+    }
+    
+    LevelConfig* config = new LevelConfig();
+    config->setPlayfieldCards(std::move(playfield));
+    config->setStackCards(std::move(stack));
+    return config;
+}
+
+const LevelEntry* LevelPackReader::findEntry(int levelId) const
+{
+    if (!_data)
+        return nullptr;
+    
+    const FileHeader* head = header();
+    int64_t index = static_cast<int64_t>(levelId) - head->firstLevelId;
+    if (index < 0 || index >= static_cast<int64_t>(head->levelCount))
+        return nullptr;
+    
+    const LevelEntry* entry = reinterpret_cast<const LevelEntry*>(_data + sizeof(FileHeader)) + index;
+    return entry->offset != 0 ? entry : nullptr;
+}
+
+bool LevelPackReader::validate() const
+{
+    if (_size < sizeof(FileHeader))
+        return false;
+    
+    const FileHeader* head = header();
+    if (head->magic != kMagic || head->version != kVersion || head->headerSize != sizeof(FileHeader)
+        || head->entrySize != sizeof(LevelEntry) || head->cardSize != sizeof(CardRecord) || head->totalSize > _size)
+        return false;
+    
+    uint64_t recordsBegin = sizeof(FileHeader) + static_cast<uint64_t>(head->levelCount) * sizeof(LevelEntry);
+    if (recordsBegin > head->totalSize)
+        return false;
+    
+    const LevelEntry* entries = reinterpret_cast<const LevelEntry*>(_data + sizeof(FileHeader));
+    for (uint32_t i = 0; i < head->levelCount; ++i)
+    {
+        const LevelEntry& entry = entries[i];
+        if (entry.offset == 0)
+            continue;
+        
+        uint32_t cardCount = static_cast<uint32_t>(entry.playfieldCount) + entry.stackCount;
+        uint64_t end = entry.offset + static_cast<uint64_t>(cardCount) * sizeof(CardRecord);
+        if (entry.offset < recordsBegin || entry.offset % alignof(CardRecord) != 0 || end > head->totalSize)
+            return false;
+        
+        // 点数花色的范围与JSON加载一致，越界的编码会让查表和纹理索引越界
+        const CardRecord* records = reinterpret_cast<const CardRecord*>(_data + entry.offset);
+        for (uint32_t j = 0; j < cardCount; ++j)
+        {
+            CardCode card = CardCode::fromBits(records[j].code);
+            int face = card.getFace();
+            int suit = card.getSuit();
+            if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES || suit < CST_CLUBS || suit >= CST_NUM_CARD_SUIT_TYPES)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool LevelPackReader::mapFile(const std::string& fullPath)
+{
+#ifdef _WIN32
+    int length = MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, nullptr, 0);
+    std::wstring widePath(length > 0 ? length - 1 : 0, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, &widePath[0], length);
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    _fileHandle = file;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)))
+        return false;
+    
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+        return false;
+    
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    _mappingHandle = mapping;
+    size_t bytes = static_cast<size_t>(size.QuadPart);
+#else
+    _fd = ::open(fullPath.c_str(), O_RDONLY);
+    if (_fd < 0)
+        return false;
+    
+    struct stat info;
+    if (fstat(_fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader))
+        return false;
+    
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+#endif
+
+    _data = static_cast<const uint8_t*>(data);
+    _size = bytes;
+    _mapped = true;
+    return true;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file LevelPackReader.h
+ * @brief 关卡包读取器头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 只读映射tools/LevelPackCompiler编译出的关卡包，按关卡ID O(1)定位卡牌记录
+ */
+
+#ifndef __LEVEL_PACK_READER_H__
+#define __LEVEL_PACK_READER_H__
+
+#include "cocos2d.h"
+#include "../models/LevelConfig.h"
+#include "../../utils/LevelPackFormat.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class LevelPackReader
+ * @brief 关卡包读取器
+ *
+ * 打开方式：
+ * - 优先以只读方式mmap整个文件，关卡数据按需由系统换页读入，打开本身不读取卡牌记录
+ * - 文件无法映射时（如Android安装包内的资源）退回一次性读入内存
+ * - open时一次性校验文件头和全部索引项的边界，之后的访问不再检查
+ *
+ * 访问：关卡ID减去起始ID即索引下标，卡牌记录在映射内存上原地读取
+ */
+class LevelPackReader
+{
+public:
+    LevelPackReader();
+    ~LevelPackReader();
+    
+    /**
+     * 打开关卡包
+     * @param path 文件路径（可为FileUtils搜索路径中的相对路径）
+     * @return 文件不存在、格式不符或越界时返回false
+     */
+    bool open(const std::string& path);
+    
+    // 解除映射并关闭文件
+    void close();
+    
+    bool isOpen() const { return _data != nullptr; }
+    
+    size_t getLevelCount() const;
+    
+    // 关卡包中是否有该关卡，O(1)
+    bool hasLevel(int levelId) const;
+    
+    // 关卡的卡牌数，关卡不存在时为0
+    size_t getPlayfieldCount(int levelId) const;
+    size_t getStackCount(int levelId) const;
+    
+    /**
+     * 关卡卡牌记录的首地址（原地访问），先getPlayfieldCount张游戏区卡牌，后getStackCount张手牌堆卡牌
+     * @return 关卡不存在时返回nullptr
+     */
+    const LevelPackFormat::CardRecord* getCards(int levelId) const;
+    
+    /**
+     * 生成关卡配置，卡牌数组按记录数一次分配
+     * @return 生成的关卡配置，调用方负责内存管理；关卡不存在时返回nullptr
+     */
+    LevelConfig* createLevelConfig(int levelId) const;
+
+private:
+    const LevelPackFormat::FileHeader* header() const { return reinterpret_cast<const LevelPackFormat::FileHeader*>(_data); }
+    const LevelPackFormat::LevelEntry* findEntry(int levelId) const;
+    
+    // 校验已映射/读入的数据：文件头、索引范围，以及每张卡牌记录的点数花色
+    bool validate() const;
+    
+    // 只读映射文件
+    bool mapFile(const std::string& fullPath);
+    
+    const uint8_t* _data;           // 映射区或_buffer的首地址
+    size_t _size;                   // 数据字节数
+    bool _mapped;                   // _data是否为映射区
+    std::vector<uint8_t> _buffer;   // 无法映射时读入的文件内容
+#ifdef _WIN32
+    void* _fileHandle;
+    void* _mappingHandle;
+#else
+    int _fd;
+#endif
+};
+
+#endif // __LEVEL_PACK_READER_H__
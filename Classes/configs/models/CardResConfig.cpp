@@ -4,6 +4,48 @@ USING_NS_CC;
 
 const Size CardResConfig::kCardSize = Size(160, 220);
 
+namespace
+{
+    /**
+     * 预先查好的卡牌精灵帧
+     * 持有引用，SpriteFrameCache清理未使用的精灵帧后指针仍然有效
+     */
+    struct CardFrameTable
+    {
+        SpriteFrame* numbers[2][2][CFT_NUM_CARD_FACE_TYPES];   // [大号][红色][点数]
+        SpriteFrame* suits[CST_NUM_CARD_SUIT_TYPES];
+        SpriteFrame* background;
+        bool loaded;
+    };
+    
+    CardFrameTable& frameTable()
+    {
+        static CardFrameTable table = {};
+        return table;
+    }
+    
+    /**
+     * 按图片路径取精灵帧，图集中没有时单独加载纹理并以同名注册
+     * @return 已retain的精灵帧，图片缺失时返回nullptr
+     */
+    SpriteFrame* retainFrame(const std::string& path)
+    {
+        SpriteFrameCache* cache = SpriteFrameCache::getInstance();
+        SpriteFrame* frame = cache->getSpriteFrameByName(path);
+        if (!frame)
+        {
+            Texture2D* texture = Director::getInstance()->getTextureCache()->addImage(path);
+            if (!texture)
+                return nullptr;
+            
+            frame = SpriteFrame::createWithTexture(texture, Rect(Vec2::ZERO, texture->getContentSize()));
+            cache->addSpriteFrame(frame, path);
+        }
+        frame->retain();
+        return frame;
+    }
+}
+
 CardResConfig::CardResConfig()
 {
 }
@@ -59,6 +101,97 @@ std::string CardResConfig::getCardBackgroundPath()
     return "res/card_general.png";
 }
 
+std::vector<std::string> CardResConfig::getCardImagePaths()
+{
+    std::vector<std::string> paths;
+    paths.push_back(getCardBackgroundPath());
+    for (int isBig = 1; isBig >= 0; --isBig)
+    {
+        for (int isRed = 0; isRed < 2; ++isRed)
+        {
+            for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face)
+            {
+                paths.push_back(getNumberImagePath(static_cast<CardFaceType>(face), isRed != 0, isBig != 0));
+            }
+        }
+    }
+    for (int suit = CST_CLUBS; suit < CST_NUM_CARD_SUIT_TYPES; ++suit)
+    {
+        paths.push_back(getSuitImagePath(static_cast<CardSuitType>(suit)));
+    }
+    return paths;
+}
+
+std::string CardResConfig::getCardAtlasPath()
+{
+    return "res/cards.plist";
+}
+
+void CardResConfig::loadCardFrames()
+{
+    CardFrameTable& table = frameTable();
+    if (table.loaded)
+        return;
+    
+    // 图集缺失时（未运行打包工具）退回逐个图片加载，显示效果相同，只是不能合批
+    std::string atlasPath = getCardAtlasPath();
+    if (FileUtils::getInstance()->isFileExist(atlasPath))
+    {
+        SpriteFrameCache::getInstance()->addSpriteFramesWithFile(atlasPath);
+    }
+    else
+    {
+        CCLOG("CardResConfig: %s not found, loading card images one by one", atlasPath.c_str());
+    }
+    
+    for (int isBig = 0; isBig < 2; ++isBig)
+    {
+        for (int isRed = 0; isRed < 2; ++isRed)
+        {
+            for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face)
+            {
+                table.numbers[isBig][isRed][face] = retainFrame(getNumberImagePath(static_cast<CardFaceType>(face), isRed != 0, isBig != 0));
+            }
+        }
+    }
+    for (int suit = CST_CLUBS; suit < CST_NUM_CARD_SUIT_TYPES; ++suit)
+    {
+        table.suits[suit] = retainFrame(getSuitImagePath(static_cast<CardSuitType>(suit)));
+    }
+    table.background = retainFrame(getCardBackgroundPath());
+    table.loaded = true;
+}
+
+SpriteFrame* CardResConfig::getNumberFrame(CardFaceType face, bool isRed, bool isBig)
+{
+    loadCardFrames();
+    
+    // 无效点数与getNumberImagePath一样按A处理
+    if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES)
+    {
+        face = CFT_ACE;
+    }
+    return frameTable().numbers[isBig ? 1 : 0][isRed ? 1 : 0][face];
+}
+
+SpriteFrame* CardResConfig::getSuitFrame(CardSuitType suit)
+{
+    loadCardFrames();
+    
+    // 无效花色与getSuitImagePath一样按红桃处理
+    if (suit < CST_CLUBS || suit >= CST_NUM_CARD_SUIT_TYPES)
+    {
+        suit = CST_HEARTS;
+    }
+    return frameTable().suits[suit];
+}
+
+SpriteFrame* CardResConfig::getCardBackgroundFrame()
+{
+    loadCardFrames();
+    return frameTable().background;
+}
+
 Size CardResConfig::getCardSize()
 {
     return kCardSize;
@@ -66,5 +199,5 @@ Size CardResConfig::getCardSize()
 
 bool CardResConfig::isRedSuit(CardSuitType suit)
 {
-    return (suit == CST_HEARTS || suit == CST_DIAMONDS);
+    return CardCode::isRedSuit(suit);
 }
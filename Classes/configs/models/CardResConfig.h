@@ -3,10 +3,16 @@
 
 #include "cocos2d.h"
 #include "../../utils/CardTypes.h"
+#include "../../utils/CardCode.h"
+#include <string>
+#include <vector>
 
 /**
  * 卡牌UI资源配置类
  * 提供卡牌资源路径映射和UI配置
+ *
+ * 卡牌图片由tools/CardAtlasPacker打包为一张图集，精灵帧名即原图片路径；
+ * 精灵帧在首次使用时一次加载并按点数/花色查好，卡牌精灵共用同一张纹理，可以合批绘制
  */
 class CardResConfig
 {
@@ -36,6 +42,48 @@ public:
      */
     static std::string getCardBackgroundPath();
     
+    /**
+     * 获取卡牌用到的全部图片路径（卡牌背景、大小号数字、花色）
+     * 图集打包工具与逐个加载共用这份列表
+     * @return 图片路径列表
+     */
+    static std::vector<std::string> getCardImagePaths();
+    
+    /**
+     * 获取卡牌图集路径
+     * @return cocos2d SpriteFrameCache格式的plist路径，纹理与其同名
+     */
+    static std::string getCardAtlasPath();
+    
+    /**
+     * 加载卡牌精灵帧并预先查好所有句柄，重复调用直接返回
+     * 有图集时一次加入SpriteFrameCache；图集中没有的图片单独加载为同名精灵帧
+     * 获取精灵帧时会自动调用，也可以在进入游戏前预先调用
+     */
+    static void loadCardFrames();
+    
+    /**
+     * 获取卡牌数字精灵帧，O(1)
+     * @param face 卡牌点数
+     * @param isRed 是否为红色（红桃/方块）
+     * @param isBig 是否为大号字体
+     * @return 精灵帧（常驻，不需要retain），图片缺失时返回nullptr
+     */
+    static cocos2d::SpriteFrame* getNumberFrame(CardFaceType face, bool isRed, bool isBig = true);
+    
+    /**
+     * 获取花色精灵帧，O(1)
+     * @param suit 花色类型
+     * @return 精灵帧，图片缺失时返回nullptr
+     */
+    static cocos2d::SpriteFrame* getSuitFrame(CardSuitType suit);
+    
+    /**
+     * 获取卡牌背景精灵帧
+     * @return 精灵帧，图片缺失时返回nullptr
+     */
+    static cocos2d::SpriteFrame* getCardBackgroundFrame();
+    
     /**
      * 获取卡牌尺寸
      * @return 卡牌的标准尺寸
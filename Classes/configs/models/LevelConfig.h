@@ -14,6 +14,8 @@
 
 #include "cocos2d.h"
 #include "../../utils/CardTypes.h"
+#include "../../utils/CardCode.h"
+#include <utility>
 #include <vector>
 
 /**
@@ -40,18 +42,18 @@ public:
      * 
      * 包含卡牌的完整属性：点数、花色和位置坐标
      * 用于描述关卡中每张卡牌的初始状态
+     * 点数和花色以单字节CardCode保存
      */
     struct CardConfig
     {
-        CardFaceType cardFace;      /**< 卡牌点数（A、2-10、J、Q、K） */
-        CardSuitType cardSuit;      /**< 卡牌花色（草花、方块、红心、黑桃） */
+        CardCode card;              /**< 卡牌点数（A、2-10、J、Q、K）和花色（草花、方块、红心、黑桃） */
         cocos2d::Vec2 position;     /**< 卡牌在游戏场景中的位置坐标 */
         
         /**
          * @brief 默认构造函数
          * 创建一个无效的卡牌配置，所有值设为默认
          */
-        CardConfig() : cardFace(CFT_NONE), cardSuit(CST_NONE), position(cocos2d::Vec2::ZERO) {}
+        CardConfig() : card(), position(cocos2d::Vec2::ZERO) {}
         
         /**
          * @brief 参数化构造函数
@@ -62,7 +64,7 @@ public:
          * 根据指定参数创建完整的卡牌配置
          */
         CardConfig(CardFaceType face, CardSuitType suit, const cocos2d::Vec2& pos) 
-            : cardFace(face), cardSuit(suit), position(pos) {}
+            : card(face, suit), position(pos) {}
     };
     
     // ==================== 构造与析构 ====================
@@ -85,6 +87,10 @@ public:
     
     // 设置手牌堆卡牌配置
     void setStackCards(const std::vector<CardConfig>& cards) { _stackCards = cards; }
+    
+    // 移入卡牌配置，加载器解析出的数组直接转交，不再复制
+    void setPlayfieldCards(std::vector<CardConfig>&& cards) { _playfieldCards = std::move(cards); }
+    void setStackCards(std::vector<CardConfig>&& cards) { _stackCards = std::move(cards); }
 
 private:
     std::vector<CardConfig> _playfieldCards;    // 游戏区域卡牌配置
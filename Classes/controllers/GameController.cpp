@@ -1,6 +1,8 @@
 #include "GameController.h"
 #include "../configs/loaders/LevelConfigLoader.h"
+#include "../configs/models/CardResConfig.h"
 #include "../services/GameModelFromLevelGenerator.h"
+#include "../views/CardFaceCompositor.h"
 
 USING_NS_CC;
 
@@ -27,11 +29,62 @@ bool GameController::init(Node* parentNode)
     // 初始化数据模型
     _undoModel = std::make_unique<UndoModel>();
     _undoManager = std::make_unique<UndoManager>();
+    _hintService = std::make_unique<HintService>();
+    _cardViewPool = std::make_unique<CardViewPool>();
+    
+    // 预先加载卡牌图集，避免第一次创建卡牌视图时卡顿
+    CardResConfig::loadCardFrames();
+    
+    // 打开走牌日志，打不开时照常游戏，只是无法恢复
+    _journal = std::make_unique<MoveJournal>();
+    if (!_journal->open(FileUtils::getInstance()->getWritablePath() + "move_journal.bin"))
+    {
+        CCLOG("Move journal unavailable, session will not be restorable");
+    }
     
     return true;
 }
 
 bool GameController::startGame(int levelId)
+{
+    if (!loadLevel(levelId))
+        return false;
+    
+    // 新对局从空日志开始
+    if (_journal)
+    {
+        _journal->beginSession(levelId, static_cast<uint32_t>(_gameModel->getCardCount()));
+    }
+    
+    return createGameView();
+}
+
+bool GameController::restoreSession(int fallbackLevelId)
+{
+    if (!_journal || !_journal->hasSession())
+        return startGame(fallbackLevelId);
+    
+    // 关卡配置变化后日志中的卡牌ID不再对应，放弃恢复
+    int levelId = _journal->getLevelId();
+    if (!loadLevel(levelId) || _gameModel->getCardCount() != _journal->getCardCount())
+    {
+        CCLOG("Move journal does not match level %d, starting a new game", levelId);
+        return startGame(fallbackLevelId);
+    }
+    
+    replayJournal();
+    if (!createGameView())
+        return false;
+    
+    if (checkWinCondition())
+    {
+        _isGameActive = false;
+        _journal->endSession();
+    }
+    return true;
+}
+
+bool GameController::loadLevel(int levelId)
 {
     // 加载关卡配置
     LevelConfig* levelConfig = LevelConfigLoader::loadLevelConfig(levelId);
@@ -41,6 +94,20 @@ bool GameController::startGame(int levelId)
         return false;
     }
     
+    // 旧关卡的提示请求不再有效
+    if (_hintService)
+    {
+        _hintService->cancel();
+    }
+    
+    // 旧视图中的卡牌ID不再对应新模型，先移除；卡牌视图回收到对象池供新关卡复用
+    if (_gameView)
+    {
+        _gameView->recycleCardViews();
+        _gameView->removeFromParent();
+        _gameView = nullptr;
+    }
+    
     // 生成游戏模型
     _gameModel.reset(GameModelFromLevelGenerator::generateGameModel(*levelConfig));
     delete levelConfig; // 释放临时配置对象
@@ -51,23 +118,35 @@ bool GameController::startGame(int levelId)
         return false;
     }
     
-    // 初始化撤销管理器
-    _undoManager->init(_undoModel.get(), _gameModel.get());
+    // 关卡加载时一次合成本关用到的牌面，之后创建卡牌视图只取精灵帧
+    CardFaceCompositor* faceCompositor = CardFaceCompositor::getInstance();
+    int composed = faceCompositor->prepareFaces(*_gameModel);
+    CCLOG("CardFaceCompositor: %d faces composed for level %d, %d/%d in texture (%.2f MB)",
+          composed, levelId, faceCompositor->getComposedCount(), CardFaceCompositor::kMaxFaces,
+          faceCompositor->getTextureBytes() / (1024.0 * 1024.0));
     
-    // 创建游戏视图
-    if (_gameView)
-    {
-        _gameView->removeFromParent();
-        _gameView = nullptr;
-    }
+    // 初始化撤销管理器（卡牌ID按关卡重新分配，旧关卡的撤销记录不再有效）
+    _undoManager->init(_undoModel.get(), _gameModel.get());
+    _undoManager->clearUndoHistory();
+    _undoManager->setUndoAnimationCallback(nullptr);
     
-    _gameView = GameView::create(_gameModel.get());
+    return true;
+}
+
+bool GameController::createGameView()
+{
+    _gameView = GameView::create(_gameModel.get(), _cardViewPool.get());
     if (!_gameView)
     {
         CCLOG("Failed to create game view");
         return false;
     }
     
+    // 新视图已按模型全部创建，之前的变化记录（如重放日志）不再需要
+    _gameModel->clearChangedCards();
+    CCLOG("CardViewPool: %zu views created, %zu reused, %zu free",
+          _cardViewPool->getCreatedCount(), _cardViewPool->getReusedCount(), _cardViewPool->getFreeCount());
+    
     _parentNode->addChild(_gameView);
     
     // 设置回调函数
@@ -79,6 +158,14 @@ bool GameController::startGame(int levelId)
         this->handleUndoClick();
     });
     
+    _gameView->setOnRedoClickCallback([this]() {
+        this->handleRedoClick();
+    });
+    
+    _gameView->setOnHintClickCallback([this]() {
+        this->handleHintClick();
+    });
+    
     // 设置撤销动画回调
     _undoManager->setUndoAnimationCallback([this](int cardId, const Vec2& targetPos, std::function<void()> callback) {
         _gameView->playUndoAnimation(cardId, targetPos, callback);
@@ -91,6 +178,46 @@ bool GameController::startGame(int levelId)
     return true;
 }
 
+void GameController::replayJournal()
+{
+    // 视图尚未创建，走牌和撤销只改模型，不播放动画
+    size_t count = _journal->getRecordCount();
+    size_t applied = 0;
+    for (; applied < count; ++applied)
+    {
+        JournalRecord record = _journal->getRecord(applied);
+        int arg = record.getArg();
+        bool success = false;
+        switch (record.getOp())
+        {
+            case JOP_PLAY:
+                success = playCard(arg);
+                break;
+            case JOP_UNDO:
+                success = arg > 0 && _undoManager->undoSteps(static_cast<size_t>(arg)) == static_cast<size_t>(arg);
+                break;
+            case JOP_REDO:
+                success = _undoManager->executeRedo();
+                break;
+            case JOP_JUMP:
+                success = _undoManager->jumpToNode(arg);
+                break;
+            default:
+                break;
+        }
+        if (!success)
+            break;
+    }
+    
+    // 不一致的记录（如写到一半被杀掉）及其后的部分丢弃，之后的操作接着有效部分追加
+    if (applied < count)
+    {
+        CCLOG("Move journal: discarding %d records that do not replay", static_cast<int>(count - applied));
+        _journal->truncate(applied);
+    }
+    CCLOG("Move journal: restored %d records", static_cast<int>(applied));
+}
+
 bool GameController::handleCardClick(int cardId)
 {
     if (!_isGameActive || _isProcessingAction || !_gameModel)
@@ -105,23 +232,15 @@ bool GameController::handleCardClick(int cardId)
         return false;
     }
     
-    bool success = false;
-    
-    // 检查卡牌是在游戏区还是牌堆中
-    auto playfieldCard = _gameModel->getPlayfieldCard(cardId);
-    if (playfieldCard)
-    {
-        // 游戏区卡牌被点击
-        success = handlePlayfieldCardClick(cardId);
-    }
-    else
-    {
-        // 牌堆卡牌被点击
-        success = handleStackCardClick(cardId);
-    }
-    
+    bool success = playCard(cardId);
     if (success)
     {
+        if (_journal)
+            _journal->append(JOP_PLAY, cardId);
+        
+        // 局面已变化，未返回的提示作废
+        if (_hintService)
+            _hintService->cancel();
         updateGameView();
         
         // 检查游戏结束条件
@@ -129,6 +248,10 @@ bool GameController::handleCardClick(int cardId)
         {
             CCLOG("Congratulations! You won!");
             _isGameActive = false;
+            
+            // 通关后不再恢复这一局
+            if (_journal)
+                _journal->endSession();
         }
     }
     
@@ -136,6 +259,20 @@ bool GameController::handleCardClick(int cardId)
     return success;
 }
 
+bool GameController::playCard(int cardId)
+{
+    // 检查卡牌是在游戏区还是牌堆中
+    auto playfieldCard = _gameModel->getPlayfieldCard(cardId);
+    if (playfieldCard)
+    {
+        // 游戏区卡牌被点击
+        return handlePlayfieldCardClick(cardId);
+    }
+    
+    // 牌堆卡牌被点击
+    return handleStackCardClick(cardId);
+}
+
 bool GameController::handlePlayfieldCardClick(int cardId)
 {
     auto card = _gameModel->getPlayfieldCard(cardId);
@@ -144,8 +281,17 @@ bool GameController::handlePlayfieldCardClick(int cardId)
     if (!card || !trayCard)
         return false;
     
-    // 检查卡牌是否可以匹配
-    if (!card->canMatch(*trayCard))
+    // 被其他卡牌压住的卡牌不能点击
+    if (!_gameModel->isCardExposed(cardId))
+    {
+        CCLOG("Card is covered by other cards");
+        return false;
+    }
+    
+    // 检查卡牌是否可以匹配：优先使用位棋盘规则，超出64张游戏区卡牌时逐张判断
+    const GameState& state = _gameModel->getGameState();
+    bool matchable = state.isValid() ? state.canMatch(cardId) : card->canMatch(*trayCard);
+    if (!matchable)
     {
         CCLOG("Card cannot match with tray card");
         return false;
@@ -157,8 +303,11 @@ bool GameController::handlePlayfieldCardClick(int cardId)
 bool GameController::handleStackCardClick(int cardId)
 {
     // 只有最顶层的牌堆卡牌可以被点击
-    auto topCard = _gameModel->getTopStackCard();
-    if (!topCard || topCard->getCardId() != cardId)
+    const GameState& state = _gameModel->getGameState();
+    bool isTop = state.isValid()
+        ? (state.canDraw() && state.getStackCardId(state.getStackSize() - 1) == cardId)
+        : (_gameModel->getTopStackCard() && _gameModel->getTopStackCard()->getCardId() == cardId);
+    if (!isTop)
     {
         CCLOG("Only top stack card can be clicked");
         return false;
@@ -175,25 +324,24 @@ bool GameController::executeCardMatch(int cardId)
     if (!card || !trayCard)
         return false;
     
-    // 记录撤销操作
-    Vec2 fromPos = card->getPosition();
-    Vec2 toPos = trayCard->getPosition();
-    auto previousTrayCard = std::make_shared<CardModel>(*trayCard); // 克隆当前托盘卡牌
+    // 记录撤销操作（只记录卡牌ID，回退时位置由模型推出）
+    Vec2 toPos = _gameModel->getTrayPosition();
     
-    _undoManager->recordMoveAction(cardId, fromPos, toPos, previousTrayCard);
-    
-    // 将匹配的卡牌移动到托盘位置并替换
-    card->setPosition(toPos);
-    _gameModel->setTrayCard(card);
+    _undoManager->recordMoveAction(cardId, trayCard->getCardId());
     
-    // 从游戏区移除卡牌
+    // 先从游戏区移除卡牌，再放到托盘位置替换底牌（保证模型索引一致）
     _gameModel->removePlayfieldCard(cardId);
+    card->setPosition(toPos);
+    _gameModel->setTrayCard(cardId);
     
-    // 播放匹配动画
-    _gameView->playMatchAnimation(cardId, toPos, [this]() {
-        // 动画完成回调
-        CCLOG("Match animation completed");
-    });
+    // 播放匹配动画（重放日志时还没有视图）
+    if (_gameView)
+    {
+        _gameView->playMatchAnimation(cardId, toPos, [this]() {
+            // 动画完成回调
+            CCLOG("Match animation completed");
+        });
+    }
     
     // 增加分数
     _gameModel->addScore(10);
@@ -203,24 +351,27 @@ bool GameController::executeCardMatch(int cardId)
 
 bool GameController::executeStackCardReplace(int cardId)
 {
-    auto stackCard = _gameModel->popStackCard();
-    auto currentTrayCard = _gameModel->getTrayCard();
-    
-    if (!stackCard || stackCard->getCardId() != cardId)
+    auto topCard = _gameModel->getTopStackCard();
+    if (!topCard || topCard->getCardId() != cardId)
         return false;
     
-    // 记录撤销操作
-    _undoManager->recordStackToTrayAction(cardId, currentTrayCard);
+    // 记录撤销操作（在修改模型之前）
+    _undoManager->recordStackToTrayAction(cardId, _gameModel->getTrayCardId());
+    
+    auto stackCard = _gameModel->popStackCard();
     
     // 将牌堆卡牌移动到托盘位置
-    Vec2 trayPos = currentTrayCard ? currentTrayCard->getPosition() : Vec2(400, 300);
+    Vec2 trayPos = _gameModel->getTrayPosition();
     stackCard->setPosition(trayPos);
-    _gameModel->setTrayCard(stackCard);
+    _gameModel->setTrayCard(cardId);
     
     // 播放移动动画
-    _gameView->playMatchAnimation(cardId, trayPos, [this]() {
-        CCLOG("Stack to tray animation completed");
-    });
+    if (_gameView)
+    {
+        _gameView->playMatchAnimation(cardId, trayPos, [this]() {
+            CCLOG("Stack to tray animation completed");
+        });
+    }
     
     return true;
 }
@@ -236,32 +387,159 @@ bool GameController::handleUndoClick()
         return false;
     }
     
+    return undoSteps(1) == 1;
+}
+
+int GameController::undoSteps(int steps)
+{
+    if (!_isGameActive || _isProcessingAction || !_undoManager || steps <= 0)
+        return 0;
+    
     _isProcessingAction = true;
     
-    bool success = _undoManager->executeUndo([this]() {
-        // 撤销动画完成回调
-        CCLOG("Undo animation completed");
-    });
+    std::vector<CardDisplacement> displacements;
+    size_t undone = _undoManager->undoSteps(static_cast<size_t>(steps), &displacements);
+    if (undone > 0)
+    {
+        if (_journal)
+            _journal->append(JOP_UNDO, static_cast<int>(undone));
+        refreshAfterBatchUndo(displacements);
+    }
     
+    _isProcessingAction = false;
+    return static_cast<int>(undone);
+}
+
+int GameController::createUndoCheckpoint()
+{
+    return _undoManager ? _undoManager->createCheckpoint() : -1;
+}
+
+bool GameController::undoToCheckpoint(int checkpointId)
+{
+    if (!_isGameActive || _isProcessingAction || !_undoManager)
+        return false;
+    
+    _isProcessingAction = true;
+    
+    // 检查点不写入日志，按撤销的步数记录
+    int depth = _undoModel->getNodeDepth(_undoManager->getCurrentNode());
+    std::vector<CardDisplacement> displacements;
+    bool success = _undoManager->undoToCheckpoint(checkpointId, &displacements);
     if (success)
     {
-        // 立即更新视图，不等待动画完成
-        updateGameView();
-        _isProcessingAction = false; // 重置处理状态
+        int undone = depth - _undoModel->getNodeDepth(_undoManager->getCurrentNode());
+        if (_journal && undone > 0)
+            _journal->append(JOP_UNDO, undone);
+        refreshAfterBatchUndo(displacements);
     }
     else
     {
-        _isProcessingAction = false; // 失败时也要重置状态
+        CCLOG("Undo checkpoint %d is not reachable", checkpointId);
+    }
+    
+    _isProcessingAction = false;
+    return success;
+}
+
+bool GameController::handleRedoClick()
+{
+    if (!_isGameActive || _isProcessingAction || !_undoManager)
+        return false;
+    
+    if (!_undoManager->canRedo())
+    {
+        CCLOG("No actions to redo");
+        return false;
     }
     
+    _isProcessingAction = true;
+    bool success = _undoManager->executeRedo();
+    if (success)
+    {
+        if (_journal)
+            _journal->append(JOP_REDO);
+        if (_hintService)
+            _hintService->cancel();
+        updateGameView();
+    }
+    _isProcessingAction = false;
+    
+    return success;
+}
+
+bool GameController::jumpToHistoryNode(int node)
+{
+    if (!_isGameActive || _isProcessingAction || !_undoManager)
+        return false;
+    
+    _isProcessingAction = true;
+    std::vector<CardDisplacement> displacements;
+    int startNode = _undoManager->getCurrentNode();
+    bool success = _undoManager->jumpToNode(node, &displacements);
+    
+    // 重放中途失败时局面停在路径上的某个节点，记录实际到达的节点，恢复会话时与当前局面一致
+    int reachedNode = _undoManager->getCurrentNode();
+    if (reachedNode != startNode && _journal)
+        _journal->append(JOP_JUMP, reachedNode);
+    refreshAfterBatchUndo(displacements);
+    _isProcessingAction = false;
+    
     return success;
 }
 
+bool GameController::handleHintClick()
+{
+    if (!_isGameActive || _isProcessingAction || !_gameModel || !_hintService)
+        return false;
+    
+    _hintService->requestHint(*_gameModel, [this](const HintResult& hint) {
+        // 回调在主线程执行，请求后局面未变化
+        if (!_gameView || hint.cardId < 0)
+        {
+            CCLOG("No move available");
+            return;
+        }
+        
+        if (hint.deadEnd)
+        {
+            CCLOG("Hint: level can no longer be cleared from here");
+        }
+        _gameView->showHint(hint.cardId);
+    });
+    
+    return true;
+}
+
 void GameController::updateGameView()
 {
     if (_gameView && _gameModel)
     {
         _gameView->updateDisplay(_gameModel.get());
+        _gameModel->clearChangedCards();
+        
+        // 增量更新每步都会发生，只在整体重建（换关、读档）时输出统计
+        const GameView::DisplayUpdateStats& stats = _gameView->getLastUpdateStats();
+        if (stats.fullRebuild)
+        {
+            CCLOG("GameView rebuild: %d cards checked, %d created, %d removed, %d updated",
+                  stats.cardsChecked, stats.viewsCreated, stats.viewsRemoved, stats.viewsUpdated);
+        }
+    }
+}
+
+void GameController::refreshAfterBatchUndo(const std::vector<CardDisplacement>& displacements)
+{
+    if (_hintService)
+        _hintService->cancel();
+    
+    // 视图只刷新一次，卡牌视图按模型位于终点，再从起点播放一组动画
+    updateGameView();
+    if (_gameView)
+    {
+        _gameView->playDisplacementAnimation(displacements, []() {
+            CCLOG("Undo animation completed");
+        });
     }
 }
 
@@ -279,15 +557,21 @@ void GameController::stopGame()
     _isGameActive = false;
     _isProcessingAction = false;
     
+    // 先停止提示线程，保证不会再有回调访问控制器
+    _hintService.reset();
+    
     if (_gameView)
     {
         _gameView->removeFromParent();
         _gameView = nullptr;
     }
     
+    _cardViewPool.reset();
+    CardFaceCompositor::destroyInstance();
     _gameModel.reset();
     _undoModel.reset();
     _undoManager.reset();
+    _journal.reset();
 }
 
 void GameController::pauseGame()
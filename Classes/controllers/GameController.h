@@ -17,6 +17,8 @@
 #include "../models/UndoModel.h"
 #include "../views/GameView.h"
 #include "../managers/UndoManager.h"
+#include "../managers/MoveJournal.h"
+#include "../services/HintService.h"
 #include <memory>
 
 /**
@@ -83,6 +85,16 @@ public:
      */
     bool startGame(int levelId = 1);
     
+    /**
+     * @brief 恢复上次未完成的对局
+     * @param fallbackLevelId 没有可恢复的对局时启动的关卡
+     * @return true表示对局恢复或启动成功
+     * 
+     * 按走牌日志中的关卡ID重新生成游戏模型，再在模型上重放日志中的走牌、撤销和重做，
+     * 最后只创建一次视图；日志中与局面不一致的尾部记录会被丢弃
+     */
+    bool restoreSession(int fallbackLevelId = 1);
+    
     // ==================== 事件处理方法 ====================
     
     /**
@@ -111,6 +123,53 @@ public:
      */
     bool handleUndoClick();
     
+    /**
+     * @brief 一次撤销多步操作
+     * @param steps 要撤销的步数
+     * @return 实际撤销的步数
+     * 
+     * 模型一次性回退所有步骤，视图只刷新一次，每张卡牌只播放一段从起点到终点的动画
+     */
+    int undoSteps(int steps);
+    
+    /**
+     * @brief 在当前局面创建撤销检查点
+     * @return 检查点ID，失败时返回-1
+     */
+    int createUndoCheckpoint();
+    
+    /**
+     * @brief 撤销到检查点（与undoSteps相同，只刷新一次视图）
+     * @param checkpointId createUndoCheckpoint返回的ID
+     * @return true表示撤销成功
+     */
+    bool undoToCheckpoint(int checkpointId);
+    
+    /**
+     * @brief 处理重做按钮点击事件
+     * @return true表示重做成功，false表示没有可重做的操作
+     * 
+     * 重新执行最近一次撤销掉的操作；撤销后走了别的操作时，
+     * 原分支仍保留在历史树中，可通过jumpToHistoryNode回去
+     */
+    bool handleRedoClick();
+    
+    /**
+     * @brief 跳转到历史树中的任意节点（供调试与QA工具使用）
+     * @param node 历史节点
+     * @return true表示跳转成功
+     */
+    bool jumpToHistoryNode(int node);
+    
+    /**
+     * @brief 处理提示按钮点击事件
+     * @return true表示已发出提示请求
+     * 
+     * 提示在工作线程上计算，结果回到主线程后高亮推荐的卡牌；
+     * 玩家在结果返回前走牌或回退时请求自动取消
+     */
+    bool handleHintClick();
+    
     // ==================== 游戏状态控制 ====================
     
     /**
@@ -149,6 +208,31 @@ public:
     int getCurrentScore() const;
 
 private:
+    /**
+     * Load level config and generate a fresh game model and undo history (no view)
+     * @param levelId Level ID
+     * @return Whether loading was successful
+     */
+    bool loadLevel(int levelId);
+    
+    /**
+     * Create the game view for the current model and bind its callbacks
+     * @return Whether the view was created
+     */
+    bool createGameView();
+    
+    /**
+     * Replay the move journal on the freshly loaded model, without view or animations
+     */
+    void replayJournal();
+    
+    /**
+     * Apply a card click to the model (playfield match or stack draw)
+     * @param cardId Card ID
+     * @return Whether the move was legal
+     */
+    bool playCard(int cardId);
+    
     /**
      * Handle playfield card click
      * @param cardId Card ID
@@ -182,6 +266,12 @@ private:
      */
     void updateGameView();
     
+    /**
+     * Refresh the view once after a batch undo and play the net displacement animations
+     * @param displacements Net displacements reported by UndoManager
+     */
+    void refreshAfterBatchUndo(const std::vector<CardDisplacement>& displacements);
+    
     /**
      * Check win condition
      * @return true if won
@@ -196,9 +286,12 @@ private:
     // 视图组件
     GameView* _gameView;                            // 游戏视图
     cocos2d::Node* _parentNode;                     // 父节点
+    std::unique_ptr<CardViewPool> _cardViewPool;    // 卡牌视图对象池（跨关卡复用）
     
     // 管理器
     std::unique_ptr<UndoManager> _undoManager;      // 撤销管理器
+    std::unique_ptr<HintService> _hintService;      // 异步提示服务
+    std::unique_ptr<MoveJournal> _journal;          // 走牌日志（崩溃后恢复对局）
     
     // 游戏状态
     bool _isGameActive;                             // 游戏是否激活
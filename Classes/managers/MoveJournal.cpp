@@ -0,0 +1,241 @@
+#include "MoveJournal.h"
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MoveJournal::MoveJournal()
+    : _data(nullptr)
+    , _mappedBytes(0)
+#ifdef _WIN32
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mappingHandle(nullptr)
+#else
+    , _fd(-1)
+#endif
+{
+}
+
+MoveJournal::~MoveJournal()
+{
+    close();
+}
+
+bool MoveJournal::open(const std::string& path)
+{
+    close();
+    _path = path;
+    
+    size_t fileBytes = 0;
+#ifdef _WIN32
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(length > 0 ? length - 1 : 0, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        CCLOG("MoveJournal: cannot open %s", path.c_str());
+        return false;
+    }
+    _fileHandle = file;
+    
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size))
+    {
+        fileBytes = static_cast<size_t>(size.QuadPart);
+    }
+#else
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0)
+    {
+        CCLOG("MoveJournal: cannot open %s", path.c_str());
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(_fd, &info) == 0)
+    {
+        fileBytes = static_cast<size_t>(info.st_size);
+    }
+#endif
+
+    // 文件大小总是kGrowBytes的整数倍；不是时视为损坏，重新开始
+    bool reuse = fileBytes >= kGrowBytes && fileBytes % kGrowBytes == 0;
+    if (!mapFile(reuse ? fileBytes : kGrowBytes))
+    {
+        close();
+        return false;
+    }
+    
+    Header* head = header();
+    if (!reuse || head->magic != kMagic || head->version != kVersion || head->recordSize != sizeof(JournalRecord))
+    {
+        std::memset(head, 0, sizeof(Header));
+        head->magic = kMagic;
+        head->version = kVersion;
+        head->recordSize = sizeof(JournalRecord);
+        head->levelId = -1;
+    }
+    if (head->recordCount > getRecordCapacity())
+    {
+        head->recordCount = static_cast<uint32_t>(getRecordCapacity());
+    }
+    return true;
+}
+
+void MoveJournal::close()
+{
+    unmapFile();
+#ifdef _WIN32
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+#endif
+}
+
+bool MoveJournal::hasSession() const
+{
+    return _data && header()->levelId >= 0;
+}
+
+int MoveJournal::getLevelId() const
+{
+    return _data ? header()->levelId : -1;
+}
+
+uint32_t MoveJournal::getCardCount() const
+{
+    return _data ? header()->cardCount : 0;
+}
+
+size_t MoveJournal::getRecordCount() const
+{
+    return _data ? header()->recordCount : 0;
+}
+
+JournalRecord MoveJournal::getRecord(size_t index) const
+{
+    CCASSERT(index < getRecordCount(), "MoveJournal::getRecord: index out of range");
+    return records()[index];
+}
+
+void MoveJournal::beginSession(int levelId, uint32_t cardCount)
+{
+    if (!_data)
+        return;
+    
+    // 先清空记录数，再改关卡：中途被杀掉时最多留下一局空对局
+    Header* head = header();
+    head->recordCount = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    head->levelId = levelId;
+    head->cardCount = cardCount;
+}
+
+void MoveJournal::endSession()
+{
+    if (_data)
+    {
+        header()->levelId = -1;
+    }
+}
+
+bool MoveJournal::append(JournalOp op, int arg)
+{
+    if (!_data || arg < 0 || arg > JournalRecord::kMaxArg)
+        return false;
+    
+    size_t count = header()->recordCount;
+    if (count >= getRecordCapacity())
+    {
+        size_t mappedBytes = _mappedBytes;
+        if (!mapFile(mappedBytes + kGrowBytes))
+        {
+            CCLOG("MoveJournal: cannot grow %s", _path.c_str());
+            mapFile(mappedBytes);
+            return false;
+        }
+    }
+    
+    // 记录写完后才计入记录数
+    records()[count].bits = static_cast<uint32_t>(op) | static_cast<uint32_t>(arg) << 8;
+    std::atomic_thread_fence(std::memory_order_release);
+    header()->recordCount = static_cast<uint32_t>(count + 1);
+    return true;
+}
+
+void MoveJournal::truncate(size_t count)
+{
+    if (_data && count < header()->recordCount)
+    {
+        header()->recordCount = static_cast<uint32_t>(count);
+    }
+}
+
+bool MoveJournal::mapFile(size_t bytes)
+{
+    unmapFile();
+
+#ifdef _WIN32
+    // 映射大小超过文件大小时，CreateFileMapping会把文件扩展到映射大小
+    HANDLE mapping = CreateFileMappingW(_fileHandle, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                        static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (!mapping)
+        return false;
+    
+    void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    _mappingHandle = mapping;
+#else
+    struct stat info;
+    if (fstat(_fd, &info) != 0)
+        return false;
+    if (static_cast<size_t>(info.st_size) < bytes && ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+        return false;
+    
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+#endif
+
+    _data = static_cast<uint8_t*>(data);
+    _mappedBytes = bytes;
+    return true;
+}
+
+void MoveJournal::unmapFile()
+{
+    if (!_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+    _mappingHandle = nullptr;
+#else
+    munmap(_data, _mappedBytes);
+#endif
+    _data = nullptr;
+    _mappedBytes = 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file MoveJournal.h
+ * @brief 走牌日志头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把每一步走牌、撤销、重做追加写入磁盘上的二进制日志，应用被杀掉后可从关卡ID加日志重建局面
+ */
+
+#ifndef __MOVE_JOURNAL_H__
+#define __MOVE_JOURNAL_H__
+
+#include "cocos2d.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * 日志操作类型
+ */
+enum JournalOp
+{
+    JOP_NONE = 0,
+    JOP_PLAY,           // 点击卡牌（游戏区匹配或翻手牌堆），参数为卡牌ID
+    JOP_UNDO,           // 撤销，参数为步数
+    JOP_REDO,           // 重做一步
+    JOP_JUMP            // 跳转到历史树节点，参数为节点下标
+};
+
+/**
+ * 日志记录：4字节，低8位为操作类型，高24位为参数
+ */
+struct JournalRecord
+{
+    static const int kMaxArg = (1 << 24) - 1;   // 参数上限
+    
+    uint32_t bits;
+    
+    JournalOp getOp() const { return static_cast<JournalOp>(bits & 0xFFu); }
+    int getArg() const { return static_cast<int>(bits >> 8); }
+};
+
+/**
+ * @class MoveJournal
+ * @brief 只追加的走牌日志
+ *
+ * 文件布局：32字节文件头（魔数、版本、关卡ID、卡牌数、记录数）后接定长记录，按本机字节序存放。
+ *
+ * 写入方式：
+ * - 文件通过内存映射打开，追加一条记录只是写入映射内存中的4个字节，再更新文件头的记录数
+ * - 主线程不调用fsync/msync：进程被杀掉时已写入映射的页仍在系统页缓存中，由内核写回磁盘
+ * - 映射区写满时文件按kGrowBytes扩展并重新映射，均摊到每条记录上可以忽略
+ *
+ * 恢复方式：
+ * - 记录数在记录本身写完之后才更新，被截断的记录不会计入
+ * - 调用方按顺序重放记录，遇到与局面不一致的记录时用truncate丢弃其后的部分
+ */
+class MoveJournal
+{
+public:
+    static const uint32_t kMagic = 0x4C4E4A50;      // "PJNL"
+    static const uint16_t kVersion = 1;
+    static const size_t kGrowBytes = 64 * 1024;     // 每次扩展的文件大小
+    
+    MoveJournal();
+    ~MoveJournal();
+    
+    /**
+     * 打开日志文件，不存在或文件头无效时新建空日志
+     * @param path 日志文件路径
+     * @return 文件无法创建或映射时返回false
+     */
+    bool open(const std::string& path);
+    
+    // 解除映射并关闭文件
+    void close();
+    
+    bool isOpen() const { return _data != nullptr; }
+    
+    /**
+     * 日志中是否有可恢复的对局
+     */
+    bool hasSession() const;
+    
+    int getLevelId() const;
+    uint32_t getCardCount() const;
+    size_t getRecordCount() const;
+    JournalRecord getRecord(size_t index) const;
+    
+    /**
+     * 开始新对局，丢弃之前的全部记录
+     * @param levelId 关卡ID
+     * @param cardCount 关卡卡牌数，恢复时用于校验关卡配置是否变化
+     */
+    void beginSession(int levelId, uint32_t cardCount);
+    
+    /**
+     * 结束对局（通关后不再恢复）
+     */
+    void endSession();
+    
+    /**
+     * 追加一条记录
+     * @return 日志未打开、参数越界或扩展失败时返回false
+     */
+    bool append(JournalOp op, int arg = 0);
+    
+    /**
+     * 只保留前count条记录
+     */
+    void truncate(size_t count);
+
+private:
+    /**
+     * 文件头
+     */
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        int32_t levelId;            // -1表示没有对局
+        uint32_t cardCount;
+        uint32_t recordCount;
+        uint32_t reserved[3];
+    };
+    
+    Header* header() const { return reinterpret_cast<Header*>(_data); }
+    JournalRecord* records() const { return reinterpret_cast<JournalRecord*>(_data + sizeof(Header)); }
+    
+    // 可容纳的记录数
+    size_t getRecordCapacity() const { return (_mappedBytes - sizeof(Header)) / sizeof(JournalRecord); }
+    
+    // 把文件扩展到bytes并重新映射
+    bool mapFile(size_t bytes);
+    void unmapFile();
+    
+    std::string _path;
+    uint8_t* _data;             // 映射区首地址
+    size_t _mappedBytes;        // 映射区大小（等于文件大小）
+#ifdef _WIN32
+    void* _fileHandle;
+    void* _mappingHandle;
+#else
+    int _fd;
+#endif
+};
+
+#endif // __MOVE_JOURNAL_H__
@@ -1,10 +1,13 @@
 #include "UndoManager.h"
+#include <algorithm>
 
 USING_NS_CC;
 
 UndoManager::UndoManager()
     : _undoModel(nullptr)
     , _gameModel(nullptr)
+    , _inBatch(false)
+    , _trackBatchPositions(false)
 {
 }
 
@@ -16,29 +19,27 @@ void UndoManager::init(UndoModel* undoModel, GameModel* gameModel)
 {
     _undoModel = undoModel;
     _gameModel = gameModel;
+    _checkpoints.clear();
 }
 
-void UndoManager::recordMoveAction(int cardId, const Vec2& fromPosition, const Vec2& toPosition,
-                                  std::shared_ptr<CardModel> previousTrayCard)
+void UndoManager::recordMoveAction(int cardId, int previousTrayCardId)
 {
     if (!_undoModel)
         return;
     
-    UndoAction action(UAT_MOVE_CARD, cardId, fromPosition, toPosition);
-    action.previousTrayCard = previousTrayCard;
-    
-    _undoModel->addUndoAction(action);
+    CCASSERT(cardId <= UndoAction::kMaxCardId && previousTrayCardId <= UndoAction::kMaxCardId, "card id exceeds undo record range");
+    captureSnapshot();
+    _undoModel->addUndoAction(UndoAction(UAT_MOVE_CARD, cardId, previousTrayCardId));
 }
 
-void UndoManager::recordStackToTrayAction(int cardId, std::shared_ptr<CardModel> previousTrayCard)
+void UndoManager::recordStackToTrayAction(int cardId, int previousTrayCardId)
 {
     if (!_undoModel)
         return;
     
-    UndoAction action(UAT_STACK_TO_TRAY, cardId, Vec2::ZERO, Vec2::ZERO);
-    action.previousTrayCard = previousTrayCard;
-    
-    _undoModel->addUndoAction(action);
+    CCASSERT(cardId <= UndoAction::kMaxCardId && previousTrayCardId <= UndoAction::kMaxCardId, "card id exceeds undo record range");
+    captureSnapshot();
+    _undoModel->addUndoAction(UndoAction(UAT_STACK_TO_TRAY, cardId, previousTrayCardId));
 }
 
 bool UndoManager::executeUndo(const std::function<void()>& onAnimationComplete)
@@ -46,13 +47,16 @@ bool UndoManager::executeUndo(const std::function<void()>& onAnimationComplete)
     if (!canUndo())
         return false;
     
-    auto lastAction = _undoModel->getLastUndoAction();
-    if (!lastAction)
+    // 记录按值取出，移除后缓冲区中的位置可能被后续记录覆盖
+    UndoAction lastAction = *_undoModel->getLastUndoAction();
+    if (_gameModel && !canRevertAction(lastAction))
+    {
+        CCLOG("UndoManager: undo record does not match the current layout");
         return false;
-    
+    }
     _undoModel->removeLastUndoAction();
     
-    switch (lastAction->actionType)
+    switch (lastAction.actionType)
     {
         case UAT_MOVE_CARD:
             undoMoveAction(lastAction, onAnimationComplete);
@@ -70,41 +74,54 @@ bool UndoManager::executeUndo(const std::function<void()>& onAnimationComplete)
     return true;
 }
 
-void UndoManager::undoMoveAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete)
+void UndoManager::undoMoveAction(const UndoAction& action, const std::function<void()>& onComplete)
 {
     if (!_gameModel)
         return;
     
     // 找到需要移动的卡牌（当前在底牌位置）
     auto card = _gameModel->getTrayCard();
-    if (!card || card->getCardId() != action->cardId)
+    if (!card || card->getCardId() != action.cardId)
     {
         // 如果底牌不是要回退的卡牌，尝试从所有卡牌中查找
-        card = _gameModel->findCard(action->cardId);
+        card = _gameModel->findCard(action.cardId);
         if (!card)
             return;
     }
     
-    // 将卡牌从底牌位置移回游戏场地
-    card->setPosition(action->fromPosition);
-    _gameModel->addPlayfieldCard(card); // 重新添加到游戏场地
+    // 将卡牌从底牌位置移回游戏场地的初始位置
+    const Vec2& playfieldPosition = card->getOriginalPosition();
+    rememberCardPosition(card->getCardId());
+    card->setPosition(playfieldPosition);
+    _gameModel->addPlayfieldCard(card->getCardId()); // 重新添加到游戏场地
+    
+    // 恢复之前的底牌（卡牌池中的原对象）
+    restoreTrayCard(action.previousTrayCardId);
+    
+    // 播放撤销动画
+    notifyCardMoved(action.cardId, playfieldPosition, onComplete);
+}
+
+void UndoManager::undoReplaceTrayAction(const UndoAction& action, const std::function<void()>& onComplete)
+{
+    if (!_gameModel)
+        return;
     
     // 恢复之前的底牌
-    if (action->previousTrayCard)
-    {
-        _gameModel->setTrayCard(action->previousTrayCard);
-        action->previousTrayCard->setPosition(action->toPosition);
-        action->previousTrayCard->setVisible(true); // 确保可见
-    }
-    else
+    if (_gameModel->getCard(action.previousTrayCardId))
     {
-        _gameModel->setTrayCard(nullptr); // 如果之前没有底牌，清空底牌位置
+        restoreTrayCard(action.previousTrayCardId);
     }
     
-    // 播放撤销动画
-    if (_undoAnimationCallback)
+    // 将当前卡牌移回初始位置
+    auto card = _gameModel->findCard(action.cardId);
+    if (card)
     {
-        _undoAnimationCallback(action->cardId, action->fromPosition, onComplete);
+        rememberCardPosition(action.cardId);
+        card->setPosition(card->getOriginalPosition());
+        
+        // 播放撤销动画
+        notifyCardMoved(action.cardId, card->getOriginalPosition(), onComplete);
     }
     else if (onComplete)
     {
@@ -112,76 +129,351 @@ void UndoManager::undoMoveAction(std::shared_ptr<UndoAction> action, const std::
     }
 }
 
-void UndoManager::undoReplaceTrayAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete)
+void UndoManager::undoStackToTrayAction(const UndoAction& action, const std::function<void()>& onComplete)
 {
     if (!_gameModel)
         return;
     
+    // 将当前底牌放回手牌堆顶部，回到它在手牌堆中摊开的初始位置
+    auto currentTrayCard = _gameModel->getTrayCard();
+    if (currentTrayCard && currentTrayCard->getCardId() == action.cardId)
+    {
+        rememberCardPosition(action.cardId);
+        currentTrayCard->setPosition(currentTrayCard->getOriginalPosition());
+        currentTrayCard->setVisible(true); // 确保可见
+        _gameModel->addStackCard(currentTrayCard->getCardId());
+    }
+    
     // 恢复之前的底牌
-    if (action->previousTrayCard)
+    restoreTrayCard(action.previousTrayCardId);
+    
+    if (onComplete)
     {
-        _gameModel->setTrayCard(action->previousTrayCard);
-        action->previousTrayCard->setPosition(action->toPosition);
+        onComplete();
     }
+}
+
+bool UndoManager::canRevertAction(const UndoAction& action) const
+{
+    // 正向操作后该卡牌成为底牌，原底牌离开所有区域
+    if (action.cardId < 0 || _gameModel->getTrayCardId() != action.cardId)
+        return false;
     
-    // 将当前卡牌移回原位置
-    auto card = _gameModel->findCard(action->cardId);
-    if (card)
+    if (action.previousTrayCardId != -1
+        && (!_gameModel->getCard(action.previousTrayCardId) || _gameModel->getCardZone(action.previousTrayCardId) != CZ_NONE))
+        return false;
+    
+    if (action.actionType == UAT_STACK_TO_TRAY)
     {
-        card->setPosition(action->fromPosition);
-        
-        // 播放撤销动画
-        if (_undoAnimationCallback)
+        // 只能压回手牌堆上次弹出的位置
+        const std::vector<int>& stackOrder = _gameModel->getStackOrder();
+        size_t position = _gameModel->getStackCards().size();
+        return position < stackOrder.size() && stackOrder[position] == action.cardId;
+    }
+    return action.actionType == UAT_MOVE_CARD || action.actionType == UAT_REPLACE_TRAY;
+}
+
+void UndoManager::captureSnapshot()
+{
+    // 记录操作时模型尚未改动，仍是当前节点的局面
+    int current = _undoModel->getCurrentNode();
+    if (_gameModel && _undoModel->needsSnapshot(current))
+    {
+        _undoModel->storeSnapshot(current, *_gameModel);
+    }
+}
+
+void UndoManager::restoreTrayCard(int cardId)
+{
+    auto trayCard = _gameModel->getCard(cardId);
+    if (trayCard)
+    {
+        rememberCardPosition(cardId);
+        trayCard->setPosition(_gameModel->getTrayPosition());
+        trayCard->setVisible(true); // 确保可见
+    }
+    _gameModel->setTrayCard(cardId); // 之前没有底牌时为-1，清空底牌位置
+}
+
+bool UndoManager::canUndo() const
+{
+    return _undoModel && _undoModel->hasUndoActions();
+}
+
+size_t UndoManager::undoSteps(size_t steps, std::vector<CardDisplacement>* displacements)
+{
+    if (!canUndo() || !_gameModel)
+    {
+        if (displacements)
+            displacements->clear();
+        return 0;
+    }
+    
+    size_t undone = std::min(steps, _undoModel->getUndoCount());
+    int target = _undoModel->getCurrentNode();
+    for (size_t i = 0; i < undone; ++i)
+    {
+        target = _undoModel->getParentNode(target);
+    }
+    
+    beginBatch(displacements != nullptr);
+    
+    // 回退较远时恢复目标之上最近的快照再重放少量步骤，否则逐步撤销
+    int start = restoreNearestSnapshot(target, static_cast<int>(undone));
+    if (start != UndoModel::kInvalidNode)
+    {
+        replayPath(start, target);
+    }
+    else
+    {
+        size_t executed = 0;
+        while (executed < undone && executeUndo())
         {
-            _undoAnimationCallback(action->cardId, action->fromPosition, onComplete);
+            ++executed;
         }
-        else if (onComplete)
+        undone = executed;
+    }
+    
+    endBatch(displacements);
+    return undone;
+}
+
+int UndoManager::createCheckpoint()
+{
+    if (!_undoModel)
+        return -1;
+    
+    int node = _undoModel->getCurrentNode();
+    _checkpoints.push_back(Checkpoint{ node, _undoModel->getNodeSerial(node) });
+    return static_cast<int>(_checkpoints.size()) - 1;
+}
+
+bool UndoManager::undoToCheckpoint(int checkpointId, std::vector<CardDisplacement>* displacements)
+{
+    if (!_undoModel || checkpointId < 0 || checkpointId >= static_cast<int>(_checkpoints.size()))
+        return false;
+    
+    const Checkpoint& checkpoint = _checkpoints[checkpointId];
+    if (!_undoModel->isNodeValid(checkpoint.node) || _undoModel->getNodeSerial(checkpoint.node) != checkpoint.serial)
+    {
+        CCLOG("UndoManager: checkpoint %d has been evicted from history", checkpointId);
+        return false;
+    }
+    
+    // 检查点必须在当前节点到根节点的路径上，沿父节点走深度差步应正好到达
+    int current = _undoModel->getCurrentNode();
+    int steps = _undoModel->getNodeDepth(current) - _undoModel->getNodeDepth(checkpoint.node);
+    if (steps < 0)
+        return false;
+    
+    int ancestor = current;
+    for (int i = 0; i < steps; ++i)
+    {
+        ancestor = _undoModel->getParentNode(ancestor);
+    }
+    if (ancestor != checkpoint.node)
+        return false;
+    
+    return undoSteps(static_cast<size_t>(steps), displacements) == static_cast<size_t>(steps);
+}
+
+bool UndoManager::executeRedo(const std::function<void()>& onAnimationComplete)
+{
+    if (!canRedo())
+        return false;
+    
+    UndoAction redoAction = *_undoModel->getRedoAction();
+    if (!applyAction(redoAction, onAnimationComplete))
+        return false;
+    
+    _undoModel->advanceRedo();
+    return true;
+}
+
+bool UndoManager::canRedo() const
+{
+    return _undoModel && _gameModel && _undoModel->hasRedoActions();
+}
+
+bool UndoManager::jumpToNode(int node, std::vector<CardDisplacement>* displacements)
+{
+    if (!_undoModel || !_gameModel || !_undoModel->isNodeValid(node))
+        return false;
+    
+    // 先不改动局面，求出最近公共祖先和逐步撤销、重放的总步数
+    int ancestor = _undoModel->getCurrentNode();
+    int target = node;
+    int pathSteps = 0;
+    while (_undoModel->getNodeDepth(target) > _undoModel->getNodeDepth(ancestor))
+    {
+        target = _undoModel->getParentNode(target);
+        ++pathSteps;
+    }
+    while (_undoModel->getNodeDepth(ancestor) > _undoModel->getNodeDepth(target))
+    {
+        ancestor = _undoModel->getParentNode(ancestor);
+        ++pathSteps;
+    }
+    while (ancestor != target)
+    {
+        ancestor = _undoModel->getParentNode(ancestor);
+        target = _undoModel->getParentNode(target);
+        pathSteps += 2;
+    }
+    
+    beginBatch(displacements != nullptr);
+    
+    // 目标附近有快照时直接恢复快照，否则撤销到公共祖先，再沿目标分支重放
+    int start = restoreNearestSnapshot(node, pathSteps);
+    if (start == UndoModel::kInvalidNode)
+    {
+        while (_undoModel->getCurrentNode() != ancestor && executeUndo())
         {
-            onComplete();
         }
+        start = ancestor;
     }
-    else if (onComplete)
+    bool success = _undoModel->getCurrentNode() == start && replayPath(start, node);
+    
+    endBatch(displacements);
+    return success;
+}
+
+int UndoManager::getCurrentNode() const
+{
+    return _undoModel ? _undoModel->getCurrentNode() : UndoModel::kInvalidNode;
+}
+
+bool UndoManager::applyAction(const UndoAction& action, const std::function<void()>& onComplete)
+{
+    auto card = _gameModel->getCard(action.cardId);
+    if (!card || _gameModel->getTrayCardId() != action.previousTrayCardId)
+        return false;
+    
+    switch (action.actionType)
     {
-        onComplete();
+        case UAT_MOVE_CARD:
+            if (_gameModel->getCardZone(action.cardId) != CZ_PLAYFIELD)
+                return false;
+            _gameModel->removePlayfieldCard(action.cardId);
+            break;
+        case UAT_STACK_TO_TRAY:
+            if (_gameModel->getTopStackCard() != card)
+                return false;
+            _gameModel->popStackCard();
+            break;
+        case UAT_REPLACE_TRAY:
+            break;
+        default:
+            return false;
     }
+    
+    // 与正向操作相同：卡牌移到底牌位置成为新底牌
+    const Vec2& trayPosition = _gameModel->getTrayPosition();
+    rememberCardPosition(action.cardId);
+    card->setPosition(trayPosition);
+    _gameModel->setTrayCard(action.cardId);
+    
+    notifyCardMoved(action.cardId, trayPosition, onComplete);
+    return true;
 }
 
-void UndoManager::undoStackToTrayAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete)
+int UndoManager::restoreNearestSnapshot(int target, int pathSteps)
 {
-    if (!_gameModel)
-        return;
+    // 恢复快照的开销加上之后重放的步数，必须少于逐步撤销/重放的步数
+    int snapshotNode = _undoModel->findSnapshotNode(target, pathSteps - kSnapshotRestoreSteps - 1);
+    if (snapshotNode == UndoModel::kInvalidNode)
+        return UndoModel::kInvalidNode;
     
-    // 将当前底牌放回手牌堆
-    auto currentTrayCard = _gameModel->getTrayCard();
-    if (currentTrayCard && currentTrayCard->getCardId() == action->cardId)
+    // 恢复快照只移动与当前局面不同的卡牌，每张约合一步
+    int replaySteps = _undoModel->getNodeDepth(target) - _undoModel->getNodeDepth(snapshotNode);
+    int restoreSteps = kSnapshotRestoreSteps + _undoModel->countSnapshotChanges(snapshotNode, *_gameModel);
+    if (restoreSteps + replaySteps >= pathSteps)
+        return UndoModel::kInvalidNode;
+    
+    // 快照会改动任意卡牌的位置，需要净位移时批量开始时的位置要全部记下
+    if (_trackBatchPositions)
     {
-        // 设置正确的手牌堆位置（右移后的位置）
-        currentTrayCard->setPosition(Vec2(250, 400)); // 右移后的备用牌区位置
-        currentTrayCard->setVisible(true); // 确保可见
-        _gameModel->addStackCard(currentTrayCard);
+        for (int cardId = 0; cardId < static_cast<int>(_gameModel->getCardCount()); ++cardId)
+        {
+            rememberCardPosition(cardId);
+        }
     }
     
-    // 恢复之前的底牌
-    if (action->previousTrayCard)
+    _undoModel->restoreSnapshot(snapshotNode, *_gameModel);
+    _undoModel->moveToNode(snapshotNode);
+    return snapshotNode;
+}
+
+bool UndoManager::replayPath(int from, int to)
+{
+    // 从目标往上记录到起点为止的路径，再自上而下重放
+    std::vector<int> path;
+    for (int node = to; node != from; node = _undoModel->getParentNode(node))
     {
-        action->previousTrayCard->setPosition(Vec2(550, 400)); // 右移后的底牌位置
-        action->previousTrayCard->setVisible(true); // 确保可见
-        _gameModel->setTrayCard(action->previousTrayCard);
+        path.push_back(node);
     }
-    else
+    
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
     {
-        _gameModel->setTrayCard(nullptr);
+        if (!applyAction(_undoModel->getNodeAction(*it), nullptr))
+        {
+            CCLOG("UndoManager: failed to replay history node %d", *it);
+            return false;
+        }
+        _undoModel->enterChild(*it);
     }
+    return true;
+}
+
+void UndoManager::beginBatch(bool trackPositions)
+{
+    _inBatch = true;
+    _trackBatchPositions = trackPositions;
+    _batchMoves.clear();
+    if (trackPositions)
+    {
+        _batchIndex.assign(_gameModel->getCardCount(), -1);
+    }
+}
+
+void UndoManager::endBatch(std::vector<CardDisplacement>* displacements)
+{
+    _inBatch = false;
+    if (!displacements || !_trackBatchPositions)
+        return;
     
-    if (onComplete)
+    // 只保留起止位置不同的卡牌：走出去又回到原处的卡牌不需要动画
+    displacements->clear();
+    for (CardDisplacement& move : _batchMoves)
     {
-        onComplete();
+        move.to = _gameModel->getCard(move.cardId)->getPosition();
+        if (!move.to.equals(move.from))
+        {
+            displacements->push_back(move);
+        }
     }
 }
 
-bool UndoManager::canUndo() const
+void UndoManager::rememberCardPosition(int cardId)
 {
-    return _undoModel && _undoModel->hasUndoActions();
+    if (!_trackBatchPositions || !_inBatch || cardId < 0 || cardId >= static_cast<int>(_batchIndex.size()) || _batchIndex[cardId] >= 0)
+        return;
+    
+    const Vec2& position = _gameModel->getCard(cardId)->getPosition();
+    _batchIndex[cardId] = static_cast<int>(_batchMoves.size());
+    _batchMoves.push_back(CardDisplacement{ cardId, position, position });
+}
+
+void UndoManager::notifyCardMoved(int cardId, const Vec2& targetPosition, const std::function<void()>& onComplete)
+{
+    if (_undoAnimationCallback && !_inBatch)
+    {
+        _undoAnimationCallback(cardId, targetPosition, onComplete);
+    }
+    else if (onComplete)
+    {
+        onComplete();
+    }
 }
 
 void UndoManager::clearUndoHistory()
@@ -190,6 +482,7 @@ void UndoManager::clearUndoHistory()
     {
         _undoModel->clear();
     }
+    _checkpoints.clear();
 }
 
 void UndoManager::setMaxUndoSteps(size_t maxSteps)
@@ -200,6 +493,14 @@ void UndoManager::setMaxUndoSteps(size_t maxSteps)
     }
 }
 
+void UndoManager::setSnapshotInterval(int interval)
+{
+    if (_undoModel)
+    {
+        _undoModel->setSnapshotInterval(interval);
+    }
+}
+
 size_t UndoManager::getUndoCount() const
 {
     return _undoModel ? _undoModel->getUndoCount() : 0;
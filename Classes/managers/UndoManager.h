@@ -16,6 +16,7 @@
 #include "../models/UndoModel.h"
 #include "../models/GameModel.h"
 #include <functional>
+#include <vector>
 
 /**
  * @class UndoManager
@@ -41,6 +42,8 @@
 class UndoManager
 {
 public:
+    static const int kSnapshotRestoreSteps = 2;     // 恢复一份快照的固定开销，约合重放的步数（另加需移动的卡牌数）
+    
     // ==================== 构造与析构 ====================
     
     /**
@@ -69,26 +72,26 @@ public:
     // ==================== 操作记录方法 ====================
     
     /**
-     * @brief 记录卡牌移动操作
+     * @brief 记录游戏区卡牌移到底牌的操作
      * @param cardId 移动卡牌的唯一标识符
-     * @param fromPosition 卡牌的起始位置坐标
-     * @param toPosition 卡牌的目标位置坐标
-     * @param previousTrayCard 之前的底牌（如果有替换）
+     * @param previousTrayCardId 之前的底牌ID（如果有替换），-1表示没有
+     * 
+     * 只记录卡牌ID，回退时卡牌回到自身的初始位置；
+     * 须在修改游戏模型之前调用，到达快照间隔时顺便保存操作前的完整局面
      */
-    void recordMoveAction(int cardId, const cocos2d::Vec2& fromPosition, const cocos2d::Vec2& toPosition,
-                         std::shared_ptr<CardModel> previousTrayCard = nullptr);
+    void recordMoveAction(int cardId, int previousTrayCardId = -1);
     
     /**
      * 记录手牌堆到底牌的操作
      * @param cardId 移动的卡牌ID
-     * @param previousTrayCard 之前的底牌
+     * @param previousTrayCardId 之前的底牌ID，-1表示没有
      */
-    void recordStackToTrayAction(int cardId, std::shared_ptr<CardModel> previousTrayCard);
+    void recordStackToTrayAction(int cardId, int previousTrayCardId);
     
     /**
      * 执行撤销操作
      * @param onAnimationComplete 动画完成回调
-     * @return 是否成功执行撤销
+     * @return 是否成功执行撤销；记录与当前局面不一致（如存档损坏）时不做改动并返回false
      */
     bool executeUndo(const std::function<void()>& onAnimationComplete = nullptr);
     
@@ -98,6 +101,62 @@ public:
      */
     bool canUndo() const;
     
+    /**
+     * 批量撤销多步操作
+     * @param steps 要撤销的步数，超出可撤销步数时撤销到最早可回到的局面
+     * @param displacements 输出每张卡牌的净位移（可为nullptr）
+     * @return 实际撤销的步数
+     * 
+     * 所有步骤在模型上一次性回退，不逐步触发撤销动画回调；
+     * 调用方刷新一次视图后用净位移播放一组动画即可。
+     * 回退步数较多时恢复目标之上最近的状态快照，再重放不超过快照间隔的步数
+     */
+    size_t undoSteps(size_t steps, std::vector<CardDisplacement>* displacements = nullptr);
+    
+    /**
+     * 在当前历史节点创建检查点
+     * @return 检查点ID
+     */
+    int createCheckpoint();
+    
+    /**
+     * 批量撤销到检查点
+     * @param checkpointId createCheckpoint返回的ID
+     * @param displacements 输出每张卡牌的净位移（可为nullptr）
+     * @return 检查点无效、已被淘汰或不在当前节点到根节点的路径上时返回false
+     */
+    bool undoToCheckpoint(int checkpointId, std::vector<CardDisplacement>* displacements = nullptr);
+    
+    /**
+     * 执行重做操作：重新执行最近一次撤销掉的操作
+     * @param onAnimationComplete 动画完成回调
+     * @return 是否成功执行重做
+     */
+    bool executeRedo(const std::function<void()>& onAnimationComplete = nullptr);
+    
+    /**
+     * 检查是否可以重做
+     * @return true表示有操作可以重做
+     */
+    bool canRedo() const;
+    
+    /**
+     * 跳转到历史树中的任意节点
+     * @param node 目标节点（UndoModel中的节点下标）
+     * @param displacements 输出每张卡牌的净位移（可为nullptr）
+     * @return 节点无效或重放失败时返回false
+     * 
+     * 先撤销到当前节点与目标节点的最近公共祖先，再沿目标分支重放，
+     * 只经过两者路径不同的部分；目标之上不远处有状态快照时改为恢复快照再重放。
+     * 与undoSteps相同，整个过程按一次批量操作处理
+     */
+    bool jumpToNode(int node, std::vector<CardDisplacement>* displacements = nullptr);
+    
+    /**
+     * 获取当前所在的历史节点
+     */
+    int getCurrentNode() const;
+    
     /**
      * 清空所有撤销记录
      */
@@ -109,6 +168,12 @@ public:
      */
     void setMaxUndoSteps(size_t maxSteps);
     
+    /**
+     * 设置状态快照间隔
+     * @param interval 每隔多少步保存一份完整局面，0表示不保存；越小回跳越快、内存占用越多
+     */
+    void setSnapshotInterval(int interval);
+    
     /**
      * 获取当前撤销步数
      * @return 撤销步数
@@ -127,25 +192,89 @@ private:
      * @param action 撤销操作记录
      * @param onComplete 完成回调
      */
-    void undoMoveAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete);
+    void undoMoveAction(const UndoAction& action, const std::function<void()>& onComplete);
     
     /**
      * 撤销替换底牌操作
      * @param action 撤销操作记录
      * @param onComplete 完成回调
      */
-    void undoReplaceTrayAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete);
+    void undoReplaceTrayAction(const UndoAction& action, const std::function<void()>& onComplete);
     
     /**
      * 撤销手牌堆到底牌操作
      * @param action 撤销操作记录
      * @param onComplete 完成回调
      */
-    void undoStackToTrayAction(std::shared_ptr<UndoAction> action, const std::function<void()>& onComplete);
+    void undoStackToTrayAction(const UndoAction& action, const std::function<void()>& onComplete);
+    
+    /**
+     * 重新执行一步操作（重做、跳转时使用）
+     * @param action 操作记录
+     * @param onComplete 完成回调
+     * @return 模型状态与记录不一致时返回false
+     */
+    bool applyAction(const UndoAction& action, const std::function<void()>& onComplete);
+    
+    /**
+     * 撤销记录能否作用于当前局面：卡牌是当前底牌、原底牌已离场，手牌堆卡牌压回原位置
+     * @param action 撤销操作记录
+     */
+    bool canRevertAction(const UndoAction& action) const;
+    
+    /**
+     * 把卡牌池中的原卡牌放回底牌位置
+     * @param cardId 卡牌ID，-1表示清空底牌
+     */
+    void restoreTrayCard(int cardId);
+    
+    // 当前节点需要快照时保存当前局面
+    void captureSnapshot();
+    
+    /**
+     * 恢复目标节点之上最近的快照（仅当比逐步撤销/重放更快时）
+     * @param target 目标节点
+     * @param pathSteps 不用快照时需要撤销和重放的总步数
+     * @return 恢复的快照节点（已成为当前节点），没有合适的快照时返回kInvalidNode
+     */
+    int restoreNearestSnapshot(int target, int pathSteps);
+    
+    /**
+     * 从祖先节点沿路径重放到目标节点
+     * @return 重放失败（模型与记录不一致）时返回false
+     */
+    bool replayPath(int from, int to);
+    
+    // 批量操作：期间不触发动画回调；需要净位移时记录卡牌在批量开始时的位置
+    void beginBatch(bool trackPositions);
+    void endBatch(std::vector<CardDisplacement>* displacements);
+    
+    // 修改卡牌位置前调用，记录卡牌在本次批量开始时的位置
+    void rememberCardPosition(int cardId);
+    
+    // 通知卡牌移动：批量操作中直接完成，否则交给动画回调
+    void notifyCardMoved(int cardId, const cocos2d::Vec2& targetPosition, const std::function<void()>& onComplete);
 
 private:
+    /**
+     * 检查点：保存节点下标和创建序号，节点被淘汰复用后序号不再匹配
+     */
+    struct Checkpoint
+    {
+        int node;
+        uint32_t serial;
+    };
+    
+    
     UndoModel* _undoModel;                  // 撤销数据模型
     GameModel* _gameModel;                  // 游戏数据模型
+    std::vector<Checkpoint> _checkpoints;   // 检查点
+    
+    // 批量操作状态
+    bool _inBatch;                                  // 是否处于批量操作中
+    bool _trackBatchPositions;                      // 本次批量是否需要输出净位移
+    std::vector<int> _batchIndex;                   // 卡牌ID到_batchMoves下标，-1表示未移动
+    std::vector<CardDisplacement> _batchMoves;      // 本次批量中移动过的卡牌
     
     // 动画回调
     std::function<void(int, const cocos2d::Vec2&, std::function<void()>)> _undoAnimationCallback;
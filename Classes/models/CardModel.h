@@ -16,6 +16,7 @@
 
 #include "cocos2d.h"
 #include "../utils/CardTypes.h"
+#include "../utils/CardCode.h"
 
 /**
  * @class CardModel
@@ -51,6 +52,14 @@ public:
      */
     CardModel(int cardId, CardFaceType face, CardSuitType suit, const cocos2d::Vec2& position);
     
+    /**
+     * @brief 使用紧凑编码构造
+     * @param cardId 卡牌的唯一标识符
+     * @param code 打包了点数和花色的单字节编码
+     * @param position 卡牌在游戏场景中的初始位置坐标
+     */
+    CardModel(int cardId, CardCode code, const cocos2d::Vec2& position);
+    
     /**
      * @brief 析构函数
      * 清理卡牌模型占用的资源
@@ -69,13 +78,19 @@ public:
      * @brief 获取卡牌点数
      * @return 卡牌的点数值（A、2-10、J、Q、K）
      */
-    CardFaceType getFace() const { return _face; }
+    CardFaceType getFace() const { return _code.getFace(); }
     
     /**
      * @brief 获取卡牌花色
      * @return 卡牌的花色（黑桃、红心、方块、草花）
      */
-    CardSuitType getSuit() const { return _suit; }
+    CardSuitType getSuit() const { return _code.getSuit(); }
+    
+    /**
+     * @brief 获取卡牌紧凑编码
+     * @return 打包了点数和花色的单字节编码
+     */
+    CardCode getCode() const { return _code; }
     
     /**
      * @brief 获取卡牌当前位置
@@ -117,7 +132,7 @@ public:
      * 
      * 更改卡牌的点数，通常在游戏初始化时使用
      */
-    void setFace(CardFaceType face) { _face = face; }
+    void setFace(CardFaceType face) { _code = CardCode(face, _code.getSuit()); }
     
     /**
      * @brief 设置卡牌花色
@@ -125,7 +140,7 @@ public:
      * 
      * 更改卡牌的花色，通常在游戏初始化时使用
      */
-    void setSuit(CardSuitType suit) { _suit = suit; }
+    void setSuit(CardSuitType suit) { _code = CardCode(_code.getFace(), suit); }
     
     /**
      * @brief 设置卡牌位置
@@ -168,8 +183,9 @@ public:
      * 
      * 游戏规则：两张卡牌的点数差值为1即可匹配，不限制花色
      * 例如：A可以和2匹配，5可以和4或6匹配，K可以和Q匹配
+     * 通过CardCode的匹配位表一次查表完成
      */
-    bool canMatch(const CardModel& other) const;
+    bool canMatch(const CardModel& other) const { return _code.canMatch(other._code); }
     
     /**
      * @brief 获取卡牌点数的数值
@@ -178,7 +194,7 @@ public:
      * 将卡牌点数枚举转换为数值用于匹配计算：
      * A=1, 2-10=对应数值, J=11, Q=12, K=13
      */
-    int getFaceValue() const;
+    int getFaceValue() const { return _code.getFaceValue(); }
     
     /**
      * @brief 克隆卡牌对象
@@ -192,12 +208,11 @@ public:
 private:
     // ==================== 私有成员变量 ====================
     int _cardId;                        // 卡牌唯一标识符
-    CardFaceType _face;                 // 卡牌点数值
-    CardSuitType _suit;                 // 卡牌花色
-    cocos2d::Vec2 _position;            // 当前位置坐标
-    cocos2d::Vec2 _originalPosition;    // 原始位置坐标（用于撤销）
+    CardCode _code;                     // 卡牌点数和花色的紧凑编码
     bool _isVisible;                    // 可见性状态
     bool _isMoving;                     // 移动状态标记
+    cocos2d::Vec2 _position;            // 当前位置坐标
+    cocos2d::Vec2 _originalPosition;    // 原始位置坐标（用于撤销）
 };
 
 #endif // __CARD_MODEL_H__
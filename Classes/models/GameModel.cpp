@@ -1,9 +1,57 @@
 #include "GameModel.h"
+#include <algorithm>
+#include <bitset>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAME_MODEL_USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GAME_MODEL_USE_NEON 1
+#endif
 
 USING_NS_CC;
 
+namespace
+{
+    /**
+     * 比较16个点数编码，返回等于faceA或faceB的位置掩码（第i位对应faces[i]）
+     */
+    inline uint32_t matchFaces16(const uint8_t* faces, uint8_t faceA, uint8_t faceB)
+    {
+#if defined(GAME_MODEL_USE_SSE2)
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(faces));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(faceA))),
+                                   _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(faceB))));
+        return static_cast<uint32_t>(_mm_movemask_epi8(hit));
+#elif defined(GAME_MODEL_USE_NEON)
+        static const uint8_t kWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t v = vld1q_u8(faces);
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, vdupq_n_u8(faceA)), vceqq_u8(v, vdupq_n_u8(faceB)));
+        uint8x16_t bits = vandq_u8(hit, vld1q_u8(kWeights));
+        uint8x8_t lo = vget_low_u8(bits);
+        uint8x8_t hi = vget_high_u8(bits);
+        lo = vpadd_u8(lo, lo); lo = vpadd_u8(lo, lo); lo = vpadd_u8(lo, lo);
+        hi = vpadd_u8(hi, hi); hi = vpadd_u8(hi, hi); hi = vpadd_u8(hi, hi);
+        return static_cast<uint32_t>(vget_lane_u8(lo, 0)) | (static_cast<uint32_t>(vget_lane_u8(hi, 0)) << 8);
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            if (faces[i] == faceA || faces[i] == faceB)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+}
+
 GameModel::GameModel()
-    : _isGameActive(false)
+    : _trayCardId(-1)
+    , _trayPosition(Vec2::ZERO)
+    , _zobristHash(0)
+    , _isGameActive(false)
     , _score(0)
 {
 }
@@ -13,72 +61,504 @@ GameModel::~GameModel()
     clear();
 }
 
+void GameModel::reserveCards(size_t count)
+{
+    _cards.reserve(count);
+    _cardIndex.reserve(count);
+    _blockerCounts.reserve(count);
+    _playfieldCards.reserve(count);
+    _playfieldFaces.reserve(count);
+    _stackCards.reserve(count);
+    _changedCards.reserve(count);
+}
+
+int GameModel::createCard(CardCode code, const Vec2& position)
+{
+    // 超出reserveCards预留的容量会导致卡牌池重新分配，使已发出的指针失效
+    CCASSERT(_cards.size() < _cards.capacity(), "GameModel::createCard: call reserveCards before creating cards");
+    
+    int cardId = static_cast<int>(_cards.size());
+    _cards.emplace_back(cardId, code, position);
+    _cardIndex.emplace_back();
+    _blockerCounts.push_back(0);
+    _playfieldBits.resize((_cards.size() + 63) / 64, 0);
+    return cardId;
+}
+
+CardModel* GameModel::getCard(int cardId)
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_cards.size()))
+        return nullptr;
+    
+    return &_cards[cardId];
+}
+
+const CardModel* GameModel::getCard(int cardId) const
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_cards.size()))
+        return nullptr;
+    
+    return &_cards[cardId];
+}
+
+void GameModel::setPlayfieldCards(const std::vector<int>& cardIds)
+{
+    _playfieldCards = cardIds;
+    _playfieldFaces.assign(_playfieldCards.size(), 0);
+    rebuildZoneIndex(_playfieldCards, CZ_PLAYFIELD);
+    rebuildBlockerCounts();
+    rebuildGameState();
+    verifyZobristHash();
+}
+
+void GameModel::addPlayfieldCard(int cardId)
+{
+    if (!getCard(cardId))
+        return;
+    
+    setSlot(cardId, CZ_PLAYFIELD, static_cast<int>(_playfieldCards.size()));
+    _playfieldCards.push_back(cardId);
+    _playfieldFaces.push_back(0);
+    refreshPlayfieldFace(cardId);
+    updateCoveredCards(cardId, 1);
+    _state.registerPlayfieldCard(cardId, _cards[cardId].getCode());
+    _state.setPlayfieldPresent(cardId, true);
+    verifyZobristHash();
+}
+
 void GameModel::removePlayfieldCard(int cardId)
 {
-    auto it = std::find_if(_playfieldCards.begin(), _playfieldCards.end(),
-        [cardId](const std::shared_ptr<CardModel>& card) {
-            return card->getCardId() == cardId;
-        });
+    const CardSlot* slot = getSlot(cardId);
+    if (!slot || slot->zone != CZ_PLAYFIELD)
+        return;
     
-    if (it != _playfieldCards.end())
+    // 与末尾元素交换后弹出，保持O(1)，并修正被交换卡牌的索引
+    int index = slot->index;
+    int lastIndex = static_cast<int>(_playfieldCards.size()) - 1;
+    if (index != lastIndex)
     {
-        _playfieldCards.erase(it);
+        _playfieldCards[index] = _playfieldCards[lastIndex];
+        _playfieldFaces[index] = _playfieldFaces[lastIndex];
+        setSlot(_playfieldCards[index], CZ_PLAYFIELD, index);
     }
+    _playfieldCards.pop_back();
+    _playfieldFaces.pop_back();
+    setSlot(cardId, CZ_NONE, -1);
+    updateCoveredCards(cardId, -1);
+    _state.setPlayfieldPresent(cardId, false);
+    verifyZobristHash();
 }
 
-std::shared_ptr<CardModel> GameModel::getPlayfieldCard(int cardId) const
+CardModel* GameModel::getPlayfieldCard(int cardId)
 {
-    auto it = std::find_if(_playfieldCards.begin(), _playfieldCards.end(),
-        [cardId](const std::shared_ptr<CardModel>& card) {
-            return card->getCardId() == cardId;
-        });
+    return getCardZone(cardId) == CZ_PLAYFIELD ? &_cards[cardId] : nullptr;
+}
+
+void GameModel::setCoverage(const std::vector<int>& coverOffsets, const std::vector<int>& coveredIds)
+{
+    _coverOffsets = coverOffsets;
+    _coveredIds = coveredIds;
+    rebuildBlockerCounts();
+    rebuildGameState();
+}
+
+bool GameModel::isCardExposed(int cardId) const
+{
+    return getCardZone(cardId) == CZ_PLAYFIELD && _blockerCounts[cardId] == 0;
+}
+
+int GameModel::getBlockerCount(int cardId) const
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_blockerCounts.size()))
+        return 0;
     
-    return (it != _playfieldCards.end()) ? *it : nullptr;
+    return _blockerCounts[cardId];
 }
 
-std::shared_ptr<CardModel> GameModel::popStackCard()
+void GameModel::setStackCards(const std::vector<int>& cardIds)
+{
+    _stackCards = cardIds;
+    _stackOrder = cardIds;
+    rebuildZoneIndex(_stackCards, CZ_STACK);
+    rebuildGameState();
+    verifyZobristHash();
+}
+
+void GameModel::addStackCard(int cardId)
+{
+    if (!getCard(cardId))
+        return;
+    
+    // 压回曾弹出的位置时必须是原来那张卡牌，手牌堆始终是初始顺序的前缀；超出时视为初始手牌堆继续增长
+    size_t position = _stackCards.size();
+    if (position < _stackOrder.size())
+    {
+        CCASSERT(_stackOrder[position] == cardId, "GameModel::addStackCard: stack must stay a prefix of its initial order");
+    }
+    else
+    {
+        _stackOrder.push_back(cardId);
+    }
+    
+    setSlot(cardId, CZ_STACK, static_cast<int>(position));
+    _stackCards.push_back(cardId);
+    _state.pushStackCard(cardId, _cards[cardId].getCode());
+    verifyZobristHash();
+}
+
+CardModel* GameModel::popStackCard()
 {
     if (_stackCards.empty())
         return nullptr;
     
-    auto card = _stackCards.back();
+    int cardId = _stackCards.back();
     _stackCards.pop_back();
-    return card;
+    setSlot(cardId, CZ_NONE, -1);
+    _state.popStackCard();
+    verifyZobristHash();
+    return &_cards[cardId];
 }
 
-std::shared_ptr<CardModel> GameModel::getTopStackCard() const
+CardModel* GameModel::getTopStackCard()
 {
-    return _stackCards.empty() ? nullptr : _stackCards.back();
+    return _stackCards.empty() ? nullptr : &_cards[_stackCards.back()];
 }
 
-std::shared_ptr<CardModel> GameModel::findCard(int cardId) const
+void GameModel::setTrayCard(int cardId)
 {
-    // 在游戏区域查找
-    auto card = getPlayfieldCard(cardId);
-    if (card)
-        return card;
+    // 旧底牌若已被移入其他区域（如撤销时放回游戏区），则保留其新索引
+    if (getCardZone(_trayCardId) == CZ_TRAY)
+    {
+        setSlot(_trayCardId, CZ_NONE, -1);
+    }
     
-    // 在手牌堆查找
-    auto it = std::find_if(_stackCards.begin(), _stackCards.end(),
-        [cardId](const std::shared_ptr<CardModel>& card) {
-            return card->getCardId() == cardId;
-        });
+    _trayCardId = getCard(cardId) ? cardId : -1;
     
-    if (it != _stackCards.end())
-        return *it;
+    if (_trayCardId >= 0)
+    {
+        setSlot(_trayCardId, CZ_TRAY, 0);
+        _state.setTray(_trayCardId, _cards[_trayCardId].getCode());
+    }
+    else
+    {
+        _state.setTray(-1, CardCode());
+    }
+    verifyZobristHash();
+}
+
+CardModel* GameModel::findCard(int cardId)
+{
+    return getCardZone(cardId) != CZ_NONE ? &_cards[cardId] : nullptr;
+}
+
+uint64_t GameModel::generateLegalMoves(GameMoveList& out) const
+{
+    out.clear();
+    uint64_t playableMask = 0;
+    
+    // 手牌堆非空时给翻牌走法留一个位置
+    int matchCapacity = GameMoveList::kCapacity - (_stackCards.empty() ? 0 : 1);
+    
+    const CardModel* trayCard = getTrayCard();
+    int trayFace = trayCard ? trayCard->getCode().getFaceCode() : 0;
+    
+    if (trayFace != 0)
+    {
+        // 与底牌点数差1的两个点数编码（A/K循环），无效点数编码0不会被命中
+        uint16_t row = CardCodeTables::kMatch[trayFace];
+        uint8_t faceA = static_cast<uint8_t>(trayFace % 13 + 1);
+        uint8_t faceB = static_cast<uint8_t>((trayFace + 11) % 13 + 1);
+        CCASSERT(row == ((1u << faceA) | (1u << faceB)), "match table and SIMD faces disagree");
+        (void)row;
+        
+        size_t total = _playfieldFaces.size();
+        for (size_t base = 0; base < total; base += 16)
+        {
+            uint32_t hits;
+            size_t remain = total - base;
+            if (remain >= 16)
+            {
+                hits = matchFaces16(&_playfieldFaces[base], faceA, faceB);
+            }
+            else
+            {
+                // 末尾不足16张时拷贝到补零的临时块，避免越界读取
+                uint8_t tail[16] = { 0 };
+                for (size_t i = 0; i < remain; ++i)
+                {
+                    tail[i] = _playfieldFaces[base + i];
+                }
+                hits = matchFaces16(tail, faceA, faceB);
+            }
+            
+            while (hits)
+            {
+                int offset = 0;
+                while (((hits >> offset) & 1u) == 0)
+                {
+                    ++offset;
+                }
+                hits &= hits - 1;
+                
+                int cardId = _playfieldCards[base + offset];
+                if (out.count < matchCapacity)
+                {
+                    out.push(GameMove::match(cardId));
+                }
+                else
+                {
+                    // 缓冲区放不下时继续扫描，位掩码仍然完整
+                    out.overflowed = true;
+                }
+                if (cardId < 64)
+                {
+                    playableMask |= 1ULL << cardId;
+                }
+            }
+        }
+    }
+    
+    if (!_stackCards.empty())
+    {
+        out.push(GameMove::draw());
+    }
+    
+    return playableMask;
+}
+
+int GameModel::countLayoutChanges(const uint64_t* playfieldBits, int stackSize, int trayCardId) const
+{
+    int changes = std::abs(static_cast<int>(_stackCards.size()) - stackSize);
+    for (size_t word = 0; word < _playfieldBits.size(); ++word)
+    {
+        changes += static_cast<int>(std::bitset<64>(_playfieldBits[word] ^ playfieldBits[word]).count());
+    }
+    if (trayCardId != _trayCardId)
+    {
+        ++changes;
+    }
+    return changes;
+}
+
+void GameModel::restoreLayout(const uint64_t* playfieldBits, int stackSize, int trayCardId)
+{
+    // 游戏区：只处理在场状态不同的卡牌
+    for (size_t word = 0; word < _playfieldBits.size(); ++word)
+    {
+        uint64_t diff = _playfieldBits[word] ^ playfieldBits[word];
+        while (diff != 0)
+        {
+            uint64_t lowest = diff & (~diff + 1);
+            diff ^= lowest;
+            int cardId = static_cast<int>(word * 64 + std::bitset<64>(lowest - 1).count());
+            
+            if (playfieldBits[word] & lowest)
+            {
+                addPlayfieldCard(cardId);
+                _cards[cardId].setPosition(_cards[cardId].getOriginalPosition());
+            }
+            else
+            {
+                removePlayfieldCard(cardId);
+                _cards[cardId].setPosition(_trayPosition);
+            }
+        }
+    }
     
-    // 检查底牌
-    if (_trayCard && _trayCard->getCardId() == cardId)
-        return _trayCard;
+    // 手牌堆：按初始顺序弹出或压回
+    CCASSERT(stackSize >= 0 && stackSize <= static_cast<int>(_stackOrder.size()), "restoreLayout: stack size out of range");
+    while (static_cast<int>(_stackCards.size()) > stackSize)
+    {
+        popStackCard()->setPosition(_trayPosition);
+    }
+    while (static_cast<int>(_stackCards.size()) < stackSize)
+    {
+        int cardId = _stackOrder[_stackCards.size()];
+        addStackCard(cardId);
+        _cards[cardId].setPosition(_cards[cardId].getOriginalPosition());
+    }
     
-    return nullptr;
+    setTrayCard(trayCardId);
+    if (_trayCardId >= 0)
+    {
+        _cards[_trayCardId].setPosition(_trayPosition);
+        _cards[_trayCardId].setVisible(true);
+    }
+}
+
+void GameModel::clearChangedCards()
+{
+    for (int cardId : _changedCards)
+    {
+        _cardIndex[cardId].changed = false;
+    }
+    _changedCards.clear();
+}
+
+uint64_t GameModel::computeZobristHash() const
+{
+    uint64_t hash = 0;
+    for (size_t cardId = 0; cardId < _cardIndex.size(); ++cardId)
+    {
+        hash ^= Zobrist::key(static_cast<int>(cardId), _cardIndex[cardId].zone);
+    }
+    return hash;
+}
+
+CardZone GameModel::getCardZone(int cardId) const
+{
+    const CardSlot* slot = getSlot(cardId);
+    return slot ? slot->zone : CZ_NONE;
 }
 
 void GameModel::clear()
 {
+    _cards.clear();
+    _cardIndex.clear();
     _playfieldCards.clear();
+    _playfieldFaces.clear();
+    _coverOffsets.clear();
+    _coveredIds.clear();
+    _blockerCounts.clear();
     _stackCards.clear();
-    _trayCard.reset();
+    _stackOrder.clear();
+    _playfieldBits.clear();
+    _changedCards.clear();
+    _zobristHash = 0;
+    _trayCardId = -1;
+    _trayPosition = Vec2::ZERO;
+    _state.reset();
     _isGameActive = false;
     _score = 0;
 }
+
+void GameModel::setSlot(int cardId, CardZone zone, int index)
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_cardIndex.size()))
+        return;
+    
+    CardSlot& slot = _cardIndex[cardId];
+    if (slot.zone != zone)
+    {
+        _zobristHash ^= Zobrist::key(cardId, slot.zone) ^ Zobrist::key(cardId, zone);
+        if (slot.zone == CZ_PLAYFIELD || zone == CZ_PLAYFIELD)
+        {
+            _playfieldBits[cardId / 64] ^= 1ULL << (cardId % 64);
+        }
+        
+        if (!slot.changed)
+        {
+            slot.changed = true;
+            _changedCards.push_back(cardId);
+        }
+    }
+    slot.zone = zone;
+    slot.index = index;
+}
+
+void GameModel::verifyZobristHash() const
+{
+#if COCOS2D_DEBUG > 0
+    CCASSERT(_zobristHash == computeZobristHash(), "GameModel: incremental Zobrist hash out of sync");
+#endif
+}
+
+const GameModel::CardSlot* GameModel::getSlot(int cardId) const
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_cardIndex.size()))
+        return nullptr;
+    
+    return &_cardIndex[cardId];
+}
+
+void GameModel::rebuildZoneIndex(const std::vector<int>& cardIds, CardZone zone)
+{
+    // 先清除该区域的旧索引，再按新容器重新登记
+    for (size_t i = 0; i < _cardIndex.size(); ++i)
+    {
+        if (_cardIndex[i].zone == zone)
+        {
+            setSlot(static_cast<int>(i), CZ_NONE, -1);
+        }
+    }
+    
+    for (size_t i = 0; i < cardIds.size(); ++i)
+    {
+        setSlot(cardIds[i], zone, static_cast<int>(i));
+    }
+}
+
+void GameModel::rebuildGameState()
+{
+    _state.reset();
+    
+    for (int cardId : _playfieldCards)
+    {
+        _state.registerPlayfieldCard(cardId, _cards[cardId].getCode());
+        _state.setPlayfieldPresent(cardId, true);
+    }
+    
+    int coverCount = static_cast<int>(_coverOffsets.size()) - 1;
+    for (int blocker = 0; blocker < coverCount; ++blocker)
+    {
+        for (int i = _coverOffsets[blocker]; i < _coverOffsets[blocker + 1]; ++i)
+        {
+            _state.addCover(blocker, _coveredIds[i]);
+        }
+    }
+    _state.refreshExposure();
+    
+    for (int cardId : _stackCards)
+    {
+        _state.pushStackCard(cardId, _cards[cardId].getCode());
+    }
+    
+    if (_trayCardId >= 0)
+    {
+        _state.setTray(_trayCardId, _cards[_trayCardId].getCode());
+    }
+}
+
+void GameModel::rebuildBlockerCounts()
+{
+    std::fill(_blockerCounts.begin(), _blockerCounts.end(), 0);
+    for (int cardId : _playfieldCards)
+    {
+        updateCoveredCards(cardId, 1);
+    }
+    
+    for (int cardId : _playfieldCards)
+    {
+        refreshPlayfieldFace(cardId);
+    }
+}
+
+void GameModel::updateCoveredCards(int cardId, int delta)
+{
+    if (cardId < 0 || cardId + 1 >= static_cast<int>(_coverOffsets.size()))
+        return;
+    
+    for (int i = _coverOffsets[cardId]; i < _coverOffsets[cardId + 1]; ++i)
+    {
+        int covered = _coveredIds[i];
+        int before = _blockerCounts[covered];
+        _blockerCounts[covered] = before + delta;
+        
+        // 只有在“被压住/翻开”之间切换的卡牌需要刷新点数编码
+        if (before == 0 || _blockerCounts[covered] == 0)
+        {
+            refreshPlayfieldFace(covered);
+        }
+    }
+}
+
+void GameModel::refreshPlayfieldFace(int cardId)
+{
+    const CardSlot* slot = getSlot(cardId);
+    if (!slot || slot->zone != CZ_PLAYFIELD)
+        return;
+    
+    _playfieldFaces[slot->index] = _blockerCounts[cardId] == 0
+        ? static_cast<uint8_t>(_cards[cardId].getCode().getFaceCode())
+        : 0;
+}
@@ -3,12 +3,42 @@
 
 #include "cocos2d.h"
 #include "CardModel.h"
+#include "GameState.h"
+#include "../utils/Zobrist.h"
 #include <vector>
-#include <memory>
+
+/**
+ * 卡牌所在区域
+ */
+enum CardZone
+{
+    CZ_NONE,            // 不在任何区域
+    CZ_PLAYFIELD,       // 游戏区域
+    CZ_STACK,           // 手牌堆
+    CZ_TRAY             // 底牌
+};
 
 /**
  * 游戏数据模型
  * 管理整个游戏的运行时数据状态
+ *
+ * 所有卡牌保存在一块连续的卡牌池中，cardId即卡牌在池中的下标（句柄），
+ * 游戏区域、手牌堆和底牌只保存cardId。卡牌池在关卡加载时一次性分配，
+ * 之后不再增长，因此返回的CardModel指针在模型生命周期内保持有效。
+ *
+ * 内部维护 cardId -> (区域, 下标) 的稠密索引，
+ * 查找、移除卡牌均为O(1)，添加/弹出/替换底牌/撤销时同步更新
+ *
+ * 同时增量维护一份位棋盘GameState，供规则判断和搜索直接使用，
+ * 以及一个64位Zobrist局面哈希（所有卡牌的(cardId, 区域)键异或），
+ * 卡牌换区时在setSlot中O(1)更新，调试版本每次修改后与完整重算结果比对
+ *
+ * setSlot中同时记录换过区域的卡牌（不重复），视图据此只刷新变化的卡牌，
+ * 刷新后由控制器调用clearChangedCards清空
+ *
+ * 卡牌覆盖关系由关卡生成时计算（压缩邻接表，只从后放置的卡牌指向被它压住的卡牌，
+ * 因此是有向无环图）。每张卡牌记录压住它的在场卡牌数量，卡牌离开/回到游戏区时
+ * 只更新它直接压住的那些卡牌，翻开查询为O(1)
  */
 class GameModel
 {
@@ -16,24 +46,57 @@ public:
     GameModel();
     ~GameModel();
     
-    // 游戏区域卡牌管理
-    const std::vector<std::shared_ptr<CardModel>>& getPlayfieldCards() const { return _playfieldCards; }
-    void setPlayfieldCards(const std::vector<std::shared_ptr<CardModel>>& cards) { _playfieldCards = cards; }
-    void addPlayfieldCard(std::shared_ptr<CardModel> card) { _playfieldCards.push_back(card); }
+    // 卡牌池管理（仅在关卡加载阶段调用）
+    void reserveCards(size_t count);
+    int createCard(CardCode code, const cocos2d::Vec2& position);
+    size_t getCardCount() const { return _cards.size(); }
+    
+    // 根据cardId直接访问卡牌池，O(1)
+    CardModel* getCard(int cardId);
+    const CardModel* getCard(int cardId) const;
+    
+    // 游戏区域卡牌管理（保存cardId）
+    const std::vector<int>& getPlayfieldCards() const { return _playfieldCards; }
+    void setPlayfieldCards(const std::vector<int>& cardIds);
+    void addPlayfieldCard(int cardId);
     void removePlayfieldCard(int cardId);
-    std::shared_ptr<CardModel> getPlayfieldCard(int cardId) const;
-    
-    // 手牌堆卡牌管理
-    const std::vector<std::shared_ptr<CardModel>>& getStackCards() const { return _stackCards; }
-    void setStackCards(const std::vector<std::shared_ptr<CardModel>>& cards) { _stackCards = cards; }
-    void addStackCard(std::shared_ptr<CardModel> card) { _stackCards.push_back(card); }
-    std::shared_ptr<CardModel> popStackCard();
-    std::shared_ptr<CardModel> getTopStackCard() const;
+    CardModel* getPlayfieldCard(int cardId);
+    
+    /**
+     * 设置卡牌覆盖关系（压缩邻接表）
+     * cardId为i的卡牌压住 coveredIds[coverOffsets[i] .. coverOffsets[i+1]) 中的卡牌，
+     * 超出coverOffsets范围的卡牌不压住任何卡牌
+     */
+    void setCoverage(const std::vector<int>& coverOffsets, const std::vector<int>& coveredIds);
+    const std::vector<int>& getCoverOffsets() const { return _coverOffsets; }
+    const std::vector<int>& getCoveredIds() const { return _coveredIds; }
+    
+    // 游戏区卡牌是否已翻开（没有被任何在场卡牌压住），O(1)
+    bool isCardExposed(int cardId) const;
+    
+    // 压住该卡牌的在场卡牌数量
+    int getBlockerCount(int cardId) const;
+    
+    // 手牌堆卡牌管理（保存cardId）
+    const std::vector<int>& getStackCards() const { return _stackCards; }
+    void setStackCards(const std::vector<int>& cardIds);
+    
+    // 手牌堆初始顺序（当前手牌堆是它的前缀），存档时保存
+    const std::vector<int>& getStackOrder() const { return _stackOrder; }
+    void addStackCard(int cardId);
+    CardModel* popStackCard();
+    CardModel* getTopStackCard();
     bool isStackEmpty() const { return _stackCards.empty(); }
     
-    // 底牌管理
-    std::shared_ptr<CardModel> getTrayCard() const { return _trayCard; }
-    void setTrayCard(std::shared_ptr<CardModel> card) { _trayCard = card; }
+    // 底牌管理，-1表示没有底牌
+    int getTrayCardId() const { return _trayCardId; }
+    CardModel* getTrayCard() { return getCard(_trayCardId); }
+    const CardModel* getTrayCard() const { return getCard(_trayCardId); }
+    void setTrayCard(int cardId);
+    
+    // 底牌区位置：翻牌/匹配时卡牌移到这里；卡牌离开底牌时回到自身的初始位置（CardModel::getOriginalPosition）
+    const cocos2d::Vec2& getTrayPosition() const { return _trayPosition; }
+    void setTrayPosition(const cocos2d::Vec2& position) { _trayPosition = position; }
     
     // 游戏状态
     bool isGameActive() const { return _isGameActive; }
@@ -44,16 +107,110 @@ public:
     void addScore(int points) { _score += points; }
     void setScore(int score) { _score = score; }
     
-    // 根据ID查找卡牌
-    std::shared_ptr<CardModel> findCard(int cardId) const;
+    // 根据ID查找当前位于某一区域的卡牌
+    CardModel* findCard(int cardId);
+    
+    // 查询卡牌所在区域，O(1)
+    CardZone getCardZone(int cardId) const;
+    
+    // 位棋盘状态，随每次区域变化增量更新
+    const GameState& getGameState() const { return _state; }
+    
+    // 局面Zobrist哈希，O(1)
+    uint64_t getZobristHash() const { return _zobristHash; }
+    
+    // 遍历所有卡牌完整重算局面哈希，O(n)，用于校验
+    uint64_t computeZobristHash() const;
+    
+    /**
+     * 生成当前所有合法走法
+     * 一次SIMD扫描（SSE2/NEON，无则退回标量）比较底牌与全部游戏区卡牌点数，
+     * 被压住的卡牌点数编码为0，不会命中；结果写入定长缓冲区，不做堆分配
+     * 可匹配卡牌超过缓冲区容量时多余的匹配走法被丢弃并置out.overflowed，翻牌走法总会保留
+     * @param out 输出缓冲区：所有已翻开且可匹配的游戏区卡牌，手牌堆非空时另有一步翻牌
+     * @return 可匹配卡牌的位掩码（第i位对应cardId为i，仅覆盖cardId<64的卡牌）
+     */
+    uint64_t generateLegalMoves(GameMoveList& out) const;
+    
+    // ==================== 紧凑局面 ====================
+    // 游戏区在场卡牌的位集（第i位对应cardId为i）+ 手牌堆高度 + 底牌ID，撤销历史的状态快照使用。
+    // 手牌堆只从顶部弹出、撤销时原样压回，始终是setStackCards时初始顺序的前缀，只需记录高度；
+    // 卡牌位置由区域推出：游戏区和手牌堆的卡牌在初始位置，底牌和已离场的卡牌在底牌位置
+    
+    // 位集长度（64位字数）
+    size_t getLayoutWordCount() const { return _playfieldBits.size(); }
+    const uint64_t* getPlayfieldBits() const { return _playfieldBits.data(); }
+    
+    // 恢复到给定紧凑局面需要移动的卡牌数，O(位集长度)
+    int countLayoutChanges(const uint64_t* playfieldBits, int stackSize, int trayCardId) const;
+    
+    // 恢复紧凑局面，只移动与当前局面不同的卡牌
+    void restoreLayout(const uint64_t* playfieldBits, int stackSize, int trayCardId);
+    
+    // ==================== 变化记录 ====================
+    // 卡牌的位置和层级都由区域决定，换区是视图需要刷新的唯一原因
+    
+    // 上次clearChangedCards之后换过区域的卡牌（按首次变化的顺序，不重复）
+    const std::vector<int>& getChangedCards() const { return _changedCards; }
+    
+    // 视图刷新后清空变化记录，O(变化的卡牌数)
+    void clearChangedCards();
     
     // 清空所有卡牌
     void clear();
 
 private:
-    std::vector<std::shared_ptr<CardModel>> _playfieldCards;    // 游戏区域卡牌
-    std::vector<std::shared_ptr<CardModel>> _stackCards;        // 手牌堆卡牌
-    std::shared_ptr<CardModel> _trayCard;                       // 当前底牌
+    /**
+     * 卡牌索引项：记录卡牌所在区域及其在区域容器中的下标
+     */
+    struct CardSlot
+    {
+        CardZone zone;
+        int index;
+        bool changed;           // 是否已记入_changedCards
+        
+        CardSlot() : zone(CZ_NONE), index(-1), changed(false) {}
+    };
+    
+    // 更新索引项
+    void setSlot(int cardId, CardZone zone, int index);
+    
+    // 调试版本下校验增量哈希与完整重算结果一致
+    void verifyZobristHash() const;
+    
+    // 读取索引项，越界时返回nullptr
+    const CardSlot* getSlot(int cardId) const;
+    
+    // 根据容器内容重建某一区域的索引
+    void rebuildZoneIndex(const std::vector<int>& cardIds, CardZone zone);
+    
+    // 根据当前各区域内容重建位棋盘状态
+    void rebuildGameState();
+    
+    // 按当前游戏区内容重新统计各卡牌的覆盖者数量
+    void rebuildBlockerCounts();
+    
+    // 卡牌离开(delta=-1)/回到(delta=+1)游戏区时，更新它压住的卡牌的覆盖者数量
+    void updateCoveredCards(int cardId, int delta);
+    
+    // 按翻开状态刷新游戏区点数编码，被压住的卡牌写0，SIMD扫描时不会命中
+    void refreshPlayfieldFace(int cardId);
+    
+    std::vector<CardModel> _cards;                              // 卡牌池，下标即cardId
+    std::vector<CardSlot> _cardIndex;                           // cardId -> 区域/下标 索引
+    std::vector<int> _playfieldCards;                           // 游戏区域卡牌
+    std::vector<uint8_t> _playfieldFaces;                       // 与_playfieldCards平行的点数编码（被压住为0），供SIMD扫描
+    std::vector<int> _coverOffsets;                             // 覆盖关系邻接表的起始偏移
+    std::vector<int> _coveredIds;                               // 覆盖关系邻接表：被压住的cardId
+    std::vector<int> _blockerCounts;                            // cardId -> 压住它的在场卡牌数量
+    std::vector<int> _stackCards;                               // 手牌堆卡牌
+    std::vector<int> _stackOrder;                               // 手牌堆初始顺序（_stackCards始终是它的前缀，关卡加载时建立）
+    std::vector<uint64_t> _playfieldBits;                       // 游戏区在场卡牌位集，setSlot中同步维护
+    std::vector<int> _changedCards;                             // 上次清空后换过区域的卡牌，setSlot中记录
+    int _trayCardId;                                            // 当前底牌
+    cocos2d::Vec2 _trayPosition;                                // 底牌区位置
+    GameState _state;                                           // 位棋盘状态
+    uint64_t _zobristHash;                                      // 局面Zobrist哈希
     
     bool _isGameActive;                                         // 游戏是否进行中
     int _score;                                                 // 当前得分
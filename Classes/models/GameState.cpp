@@ -0,0 +1,178 @@
+#include "GameState.h"
+#include <algorithm>
+#include <cstring>
+
+GameState::GameState()
+{
+    reset();
+}
+
+void GameState::reset()
+{
+    _present = 0;
+    _exposed = 0;
+    std::memset(_coverMasks, 0, sizeof(_coverMasks));
+    std::memset(_blockerMasks, 0, sizeof(_blockerMasks));
+    std::memset(_faceMasks, 0, sizeof(_faceMasks));
+    std::memset(_matchMasks, 0, sizeof(_matchMasks));
+    std::fill(_playfieldCodes, _playfieldCodes + kMaxPlayfieldCards, CardCode());
+    std::fill(_stackCodes, _stackCodes + kMaxStackCards, CardCode());
+    std::memset(_stackIds, 0, sizeof(_stackIds));
+    _stackSize = 0;
+    _tray = CardCode();
+    _trayId = -1;
+    _valid = true;
+}
+
+void GameState::registerPlayfieldCard(int bit, CardCode code)
+{
+    if (bit < 0 || bit >= kMaxPlayfieldCards)
+    {
+        _valid = false;
+        return;
+    }
+    
+    uint64_t mask = 1ULL << bit;
+    int face = code.getFaceCode();
+    _playfieldCodes[bit] = code;
+    _faceMasks[face] |= mask;
+    
+    // 该卡牌可被哪些底牌点数匹配：匹配关系对称，直接查匹配表的本行
+    for (int trayFace = 0; trayFace < 16; ++trayFace)
+    {
+        if ((CardCodeTables::kMatch[face] >> trayFace) & 1)
+        {
+            _matchMasks[trayFace] |= mask;
+        }
+    }
+}
+
+void GameState::setPlayfieldPresent(int bit, bool present)
+{
+    if (bit < 0 || bit >= kMaxPlayfieldCards)
+    {
+        _valid = false;
+        return;
+    }
+    
+    if (present)
+        addPresent(bit);
+    else
+        removePresent(bit);
+}
+
+void GameState::addCover(int blocker, int covered)
+{
+    if (blocker < 0 || blocker >= kMaxPlayfieldCards || covered < 0 || covered >= kMaxPlayfieldCards)
+    {
+        _valid = false;
+        return;
+    }
+    
+    _coverMasks[blocker] |= 1ULL << covered;
+    _blockerMasks[covered] |= 1ULL << blocker;
+}
+
+void GameState::refreshExposure()
+{
+    _exposed = 0;
+    for (int bit = 0; bit < kMaxPlayfieldCards; ++bit)
+    {
+        if ((_blockerMasks[bit] & _present) == 0)
+        {
+            _exposed |= 1ULL << bit;
+        }
+    }
+}
+
+void GameState::removePresent(int bit)
+{
+    _present &= ~(1ULL << bit);
+    
+    // 只有被该卡牌压住的卡牌可能因此翻开
+    uint64_t candidates = _coverMasks[bit] & ~_exposed;
+    for (int covered = 0; candidates != 0; ++covered, candidates >>= 1)
+    {
+        if ((candidates & 1) && (_blockerMasks[covered] & _present) == 0)
+        {
+            _exposed |= 1ULL << covered;
+        }
+    }
+}
+
+void GameState::addPresent(int bit)
+{
+    _present |= 1ULL << bit;
+    _exposed &= ~_coverMasks[bit];
+    
+    if ((_blockerMasks[bit] & _present) == 0)
+        _exposed |= 1ULL << bit;
+    else
+        _exposed &= ~(1ULL << bit);
+}
+
+void GameState::pushStackCard(int cardId, CardCode code)
+{
+    if (_stackSize >= kMaxStackCards)
+    {
+        _valid = false;
+        return;
+    }
+    
+    _stackCodes[_stackSize] = code;
+    _stackIds[_stackSize] = static_cast<int16_t>(cardId);
+    ++_stackSize;
+}
+
+void GameState::popStackCard()
+{
+    if (_stackSize > 0)
+    {
+        --_stackSize;
+    }
+}
+
+void GameState::setTray(int cardId, CardCode code)
+{
+    _trayId = cardId;
+    _tray = cardId >= 0 ? code : CardCode();
+}
+
+bool GameState::isMoveLegal(const GameMove& move) const
+{
+    return move.type == GMT_MATCH ? canMatch(move.bit) : canDraw();
+}
+
+void GameState::applyMove(GameMove& move)
+{
+    move.prevTray = _tray;
+    move.prevTrayId = static_cast<int16_t>(_trayId);
+    
+    if (move.type == GMT_MATCH)
+    {
+        removePresent(move.bit);
+        _tray = _playfieldCodes[move.bit];
+        _trayId = move.bit;
+    }
+    else
+    {
+        --_stackSize;
+        _tray = _stackCodes[_stackSize];
+        _trayId = _stackIds[_stackSize];
+    }
+}
+
+void GameState::unapplyMove(const GameMove& move)
+{
+    if (move.type == GMT_MATCH)
+    {
+        addPresent(move.bit);
+    }
+    else
+    {
+        ++_stackSize;
+    }
+    
+    _tray = move.prevTray;
+    _trayId = move.prevTrayId;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file GameState.h
+ * @brief 位棋盘游戏状态头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 以64位掩码描述游戏区域的紧凑状态
+ * 不依赖cocos2d，可被求解器、提示等无界面模块直接使用
+ */
+
+#ifndef __GAME_STATE_H__
+#define __GAME_STATE_H__
+
+#include "../utils/CardCode.h"
+#include <cstdint>
+
+/**
+ * 走法类型
+ */
+enum GameMoveType
+{
+    GMT_MATCH,          // 游戏区卡牌与底牌匹配
+    GMT_DRAW            // 从手牌堆翻一张到底牌
+};
+
+/**
+ * 单步走法
+ * applyMove时记录原底牌，unapplyMove据此还原
+ */
+struct GameMove
+{
+    uint8_t type;               // 走法类型（GameMoveType）
+    CardCode prevTray;          // 走法执行前的底牌编码
+    int16_t bit;                // 匹配走法对应的游戏区位（即cardId）
+    int16_t prevTrayId;         // 走法执行前的底牌ID
+    
+    static GameMove match(int bit) { GameMove m = { GMT_MATCH, CardCode(), static_cast<int16_t>(bit), -1 }; return m; }
+    static GameMove draw() { GameMove m = { GMT_DRAW, CardCode(), 0, -1 }; return m; }
+};
+
+/**
+ * 定长走法缓冲区
+ * 生成合法走法时写入，不做任何堆分配
+ */
+struct GameMoveList
+{
+    static const int kCapacity = 256;
+    
+    GameMove moves[kCapacity];  // 走法数组
+    int count;                  // 有效走法数量
+    bool overflowed;            // 是否有走法因缓冲区已满被丢弃
+    
+    GameMoveList() : count(0), overflowed(false) {}
+    
+    void clear() { count = 0; overflowed = false; }
+    bool isFull() const { return count >= kCapacity; }
+    
+    /**
+     * @brief 追加走法，缓冲区已满时丢弃、记录overflowed并返回false
+     */
+    bool push(const GameMove& move)
+    {
+        if (count >= kCapacity)
+        {
+            overflowed = true;
+            return false;
+        }
+        moves[count++] = move;
+        return true;
+    }
+};
+
+/**
+ * @class GameState
+ * @brief 位棋盘游戏状态
+ *
+ * 游戏区第i位对应cardId为i的卡牌（关卡生成时游戏区卡牌最先创建，ID从0开始连续），
+ * 因此最多支持64张游戏区卡牌，超出时isValid()返回false，调用方应退回逐张判断。
+ *
+ * 主要数据：
+ * - 游戏区在场掩码，以及未被任何在场卡牌压住的“翻开”掩码
+ * - 卡牌覆盖关系：每张卡牌压住的卡牌掩码、压住它的卡牌掩码
+ * - 按点数编码划分的卡牌掩码，以及预先合并好的“可与某点数匹配”掩码
+ * - 手牌堆（自底向顶）及其游标
+ * - 当前底牌
+ *
+ * 规则判断和走法执行都只有少量位运算，是GameController匹配/翻牌规则的权威实现
+ */
+class GameState
+{
+public:
+    static const int kMaxPlayfieldCards = 64;
+    static const int kMaxStackCards = 64;
+    
+    GameState();
+    
+    /**
+     * @brief 清空状态
+     */
+    void reset();
+    
+    // ==================== 布局与同步（由GameModel维护） ====================
+    
+    /**
+     * @brief 登记游戏区卡牌的点数花色，不改变在场状态
+     * @param bit 游戏区位（cardId）
+     * @param code 卡牌编码
+     */
+    void registerPlayfieldCard(int bit, CardCode code);
+    
+    /**
+     * @brief 设置游戏区卡牌是否在场
+     */
+    void setPlayfieldPresent(int bit, bool present);
+    
+    /**
+     * @brief 登记覆盖关系：blocker压住covered
+     * 登记完成后需调用refreshExposure()重新计算翻开掩码
+     */
+    void addCover(int blocker, int covered);
+    
+    /**
+     * @brief 按在场掩码和覆盖关系完整重算翻开掩码
+     */
+    void refreshExposure();
+    
+    /**
+     * @brief 手牌堆压入一张卡牌（位于顶部）
+     */
+    void pushStackCard(int cardId, CardCode code);
+    
+    /**
+     * @brief 手牌堆弹出顶部卡牌
+     */
+    void popStackCard();
+    
+    /**
+     * @brief 设置当前底牌，cardId为-1表示没有底牌
+     */
+    void setTray(int cardId, CardCode code);
+    
+    /**
+     * @brief 标记状态无法用位棋盘表示（卡牌数超限）
+     */
+    void invalidate() { _valid = false; }
+    
+    // ==================== 查询 ====================
+    
+    bool isValid() const { return _valid; }
+    uint64_t getPresentMask() const { return _present; }
+    uint64_t getExposedMask() const { return _present & _exposed; }
+    uint64_t getCoverMask(int bit) const { return _coverMasks[bit]; }
+    uint64_t getBlockerMask(int bit) const { return _blockerMasks[bit]; }
+    uint64_t getFaceMask(int faceCode) const { return _present & _faceMasks[faceCode & 0x0F]; }
+    
+    /**
+     * @brief 当前可与底牌匹配的游戏区卡牌掩码（仅包含已翻开的卡牌）
+     */
+    uint64_t getMatchableMask() const { return _present & _exposed & _matchMasks[_tray.getFaceCode()]; }
+    
+    bool canMatch(int bit) const { return bit >= 0 && bit < kMaxPlayfieldCards && ((getMatchableMask() >> bit) & 1) != 0; }
+    bool canDraw() const { return _stackSize > 0; }
+    bool isCleared() const { return _present == 0; }
+    
+    CardCode getPlayfieldCode(int bit) const { return _playfieldCodes[bit]; }
+    int getStackSize() const { return _stackSize; }
+    int getStackCardId(int index) const { return _stackIds[index]; }
+    CardCode getStackCode(int index) const { return _stackCodes[index]; }
+    CardCode getTray() const { return _tray; }
+    int getTrayCardId() const { return _trayId; }
+    
+    // ==================== 走法 ====================
+    
+    /**
+     * @brief 判断走法是否合法
+     */
+    bool isMoveLegal(const GameMove& move) const;
+    
+    /**
+     * @brief 执行走法（调用方保证合法），并在move中记录还原所需的原底牌
+     */
+    void applyMove(GameMove& move);
+    
+    /**
+     * @brief 撤销applyMove执行的走法
+     */
+    void unapplyMove(const GameMove& move);
+
+private:
+    /**
+     * @brief 卡牌离场：只检查它压住的卡牌是否因此翻开
+     */
+    void removePresent(int bit);
+    
+    /**
+     * @brief 卡牌入场：它压住的卡牌重新被盖住，并按其自身的覆盖者决定是否翻开
+     */
+    void addPresent(int bit);
+    
+    uint64_t _present;                              // 游戏区在场掩码
+    uint64_t _exposed;                              // 翻开掩码（需与_present相与）
+    uint64_t _coverMasks[kMaxPlayfieldCards];       // 游戏区位 -> 它压住的卡牌掩码
+    uint64_t _blockerMasks[kMaxPlayfieldCards];     // 游戏区位 -> 压住它的卡牌掩码
+    uint64_t _faceMasks[16];                        // 点数编码 -> 游戏区卡牌掩码（含已移除卡牌）
+    uint64_t _matchMasks[16];                       // 底牌点数编码 -> 可匹配的游戏区卡牌掩码
+    CardCode _playfieldCodes[kMaxPlayfieldCards];   // 游戏区位 -> 卡牌编码
+    CardCode _stackCodes[kMaxStackCards];           // 手牌堆卡牌编码（自底向顶）
+    int16_t _stackIds[kMaxStackCards];              // 手牌堆卡牌ID（自底向顶）
+    int _stackSize;                                 // 手牌堆游标
+    CardCode _tray;                                 // 当前底牌编码
+    int _trayId;                                    // 当前底牌ID
+    bool _valid;                                    // 是否可用位棋盘表示
+};
+
+#endif // __GAME_STATE_H__
@@ -0,0 +1,155 @@
+#include "PersistentGameModel.h"
+#include "../utils/Zobrist.h"
+
+USING_NS_CC;
+
+PersistentGameModel::PersistentGameModel()
+    : _trayCardId(-1)
+    , _stackSize(0)
+    , _playfieldCount(0)
+    , _score(0)
+    , _zobristHash(0)
+{
+}
+
+PersistentGameModel PersistentGameModel::fromGameModel(const GameModel& gameModel)
+{
+    size_t cardCount = gameModel.getCardCount();
+    
+    auto layout = std::make_shared<Layout>();
+    layout->codes.reserve(cardCount);
+    layout->originalPositions.reserve(cardCount);
+    for (size_t cardId = 0; cardId < cardCount; ++cardId)
+    {
+        const CardModel* card = gameModel.getCard(static_cast<int>(cardId));
+        layout->codes.push_back(card->getCode());
+        layout->originalPositions.push_back(card->getOriginalPosition());
+    }
+    layout->coverOffsets = gameModel.getCoverOffsets();
+    layout->coveredIds = gameModel.getCoveredIds();
+    layout->stackOrder = gameModel.getStackOrder();
+    layout->trayPosition = gameModel.getTrayPosition();
+    
+    PersistentGameModel model;
+    model._layout = layout;
+    model._cards = PersistentArray<CardState>(cardCount);
+    for (size_t cardId = 0; cardId < cardCount; ++cardId)
+    {
+        CardState& state = model._cards.mutate(cardId);
+        state.blockers = static_cast<int16_t>(gameModel.getBlockerCount(static_cast<int>(cardId)));
+        state.zone = static_cast<uint8_t>(gameModel.getCardZone(static_cast<int>(cardId)));
+        state.reserved = 0;
+    }
+    model._trayCardId = gameModel.getTrayCardId();
+    model._stackSize = gameModel.getStackCards().size();
+    model._playfieldCount = gameModel.getPlayfieldCards().size();
+    model._score = gameModel.getScore();
+    model._zobristHash = gameModel.getZobristHash();
+    return model;
+}
+
+void PersistentGameModel::applyTo(GameModel& gameModel) const
+{
+    if (!_layout)
+        return;
+    
+    CCASSERT(gameModel.getCardCount() == _cards.size(), "PersistentGameModel::applyTo: model comes from another level");
+    
+    std::vector<uint64_t> playfieldBits(gameModel.getLayoutWordCount(), 0);
+    for (size_t cardId = 0; cardId < _cards.size(); ++cardId)
+    {
+        if (_cards[cardId].zone == CZ_PLAYFIELD)
+        {
+            playfieldBits[cardId >> 6] |= 1ULL << (cardId & 63);
+        }
+    }
+    
+    gameModel.restoreLayout(playfieldBits.data(), static_cast<int>(_stackSize), _trayCardId);
+    gameModel.setScore(_score);
+    CCASSERT(gameModel.getZobristHash() == _zobristHash, "PersistentGameModel::applyTo: hash mismatch");
+}
+
+CardCode PersistentGameModel::getCardCode(int cardId) const
+{
+    return isCardIdValid(cardId) ? _layout->codes[cardId] : CardCode();
+}
+
+CardZone PersistentGameModel::getCardZone(int cardId) const
+{
+    return isCardIdValid(cardId) ? static_cast<CardZone>(_cards[cardId].zone) : CZ_NONE;
+}
+
+Vec2 PersistentGameModel::getCardPosition(int cardId) const
+{
+    if (!isCardIdValid(cardId))
+        return Vec2::ZERO;
+    
+    CardZone zone = getCardZone(cardId);
+    return (zone == CZ_PLAYFIELD || zone == CZ_STACK) ? _layout->originalPositions[cardId] : _layout->trayPosition;
+}
+
+bool PersistentGameModel::isCardExposed(int cardId) const
+{
+    return getCardZone(cardId) == CZ_PLAYFIELD && _cards[cardId].blockers == 0;
+}
+
+int PersistentGameModel::getTopStackCardId() const
+{
+    return _stackSize > 0 ? _layout->stackOrder[_stackSize - 1] : -1;
+}
+
+bool PersistentGameModel::canMatch(int cardId) const
+{
+    return isCardExposed(cardId) && isCardIdValid(_trayCardId)
+        && _layout->codes[cardId].canMatch(_layout->codes[_trayCardId]);
+}
+
+bool PersistentGameModel::matchCard(int cardId, int points)
+{
+    if (!canMatch(cardId))
+        return false;
+    
+    // 离开游戏区：只更新它直接压住的卡牌
+    setZone(cardId, CZ_NONE);
+    --_playfieldCount;
+    const Layout& layout = *_layout;
+    if (cardId + 1 < static_cast<int>(layout.coverOffsets.size()))
+    {
+        for (int i = layout.coverOffsets[cardId]; i < layout.coverOffsets[cardId + 1]; ++i)
+        {
+            --_cards.mutate(layout.coveredIds[i]).blockers;
+        }
+    }
+    
+    setTrayCard(cardId);
+    _score += points;
+    return true;
+}
+
+bool PersistentGameModel::drawStackCard()
+{
+    if (!_layout || _stackSize == 0)
+        return false;
+    
+    int cardId = _layout->stackOrder[--_stackSize];
+    setZone(cardId, CZ_NONE);
+    setTrayCard(cardId);
+    return true;
+}
+
+void PersistentGameModel::setZone(int cardId, CardZone zone)
+{
+    CardState& state = _cards.mutate(cardId);
+    _zobristHash ^= Zobrist::key(cardId, state.zone) ^ Zobrist::key(cardId, zone);
+    state.zone = static_cast<uint8_t>(zone);
+}
+
+void PersistentGameModel::setTrayCard(int cardId)
+{
+    if (getCardZone(_trayCardId) == CZ_TRAY)
+    {
+        setZone(_trayCardId, CZ_NONE);
+    }
+    _trayCardId = cardId;
+    setZone(cardId, CZ_TRAY);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file PersistentGameModel.h
+ * @brief 可分叉的持久化游戏局面头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 供提示、求解、走法预演等需要从同一局面分出多条分支的场景使用，
+ * 分叉为O(1)，每一步只复制被修改的卡牌状态块
+ */
+
+#ifndef __PERSISTENT_GAME_MODEL_H__
+#define __PERSISTENT_GAME_MODEL_H__
+
+#include "cocos2d.h"
+#include "GameModel.h"
+#include "../utils/PersistentArray.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @class PersistentGameModel
+ * @brief 写时复制的游戏局面
+ *
+ * 数据划分：
+ * - 关卡布局（点数花色编码、初始位置、覆盖关系邻接表、手牌堆初始顺序、底牌位置）在对局中不变，
+ *   由所有分支通过shared_ptr共享同一份只读数据
+ * - 每张卡牌的区域和压住它的在场卡牌数量放在PersistentArray中，按32张一块写时复制
+ * - 底牌、手牌堆高度、游戏区卡牌数、得分、Zobrist哈希为标量，随对象复制
+ *
+ * 复制对象即分叉：只增加引用计数，O(1)；走一步只复制被修改卡牌所在的块和块表，
+ * 与GameModel相比不复制卡牌池、区域容器和位棋盘
+ *
+ * 卡牌位置不单独保存，与GameModel的紧凑局面一致由区域推出；游戏区顺序不保存，
+ * applyTo之后GameModel中的游戏区顺序可能与分叉前不同
+ */
+class PersistentGameModel
+{
+public:
+    PersistentGameModel();
+    
+    /**
+     * 从游戏模型生成局面，O(卡牌数)
+     */
+    static PersistentGameModel fromGameModel(const GameModel& gameModel);
+    
+    /**
+     * 分叉出一个独立的局面，O(1)
+     */
+    PersistentGameModel fork() const { return *this; }
+    
+    /**
+     * 把局面写回游戏模型
+     * 游戏模型必须来自同一关卡（fromGameModel的来源或其副本），只移动与当前局面不同的卡牌
+     */
+    void applyTo(GameModel& gameModel) const;
+    
+    bool isValid() const { return _layout != nullptr; }
+    
+    // ==================== 查询 ====================
+    
+    size_t getCardCount() const { return _cards.size(); }
+    CardCode getCardCode(int cardId) const;
+    CardZone getCardZone(int cardId) const;
+    
+    // 由区域推出的卡牌位置：游戏区和手牌堆为初始位置，其余为底牌位置
+    cocos2d::Vec2 getCardPosition(int cardId) const;
+    
+    // 游戏区卡牌是否已翻开
+    bool isCardExposed(int cardId) const;
+    
+    int getTrayCardId() const { return _trayCardId; }
+    size_t getStackSize() const { return _stackSize; }
+    int getTopStackCardId() const;
+    size_t getPlayfieldCount() const { return _playfieldCount; }
+    int getScore() const { return _score; }
+    uint64_t getZobristHash() const { return _zobristHash; }
+    
+    // 卡牌是否可与底牌匹配（需已翻开）
+    bool canMatch(int cardId) const;
+    
+    // ==================== 走法 ====================
+    
+    /**
+     * 游戏区卡牌与底牌匹配，成为新底牌
+     * @param points 匹配得分
+     * @return 卡牌未翻开或不能匹配时返回false，局面不变
+     */
+    bool matchCard(int cardId, int points);
+    
+    /**
+     * 翻开手牌堆顶部的卡牌作为新底牌
+     * @return 手牌堆为空时返回false
+     */
+    bool drawStackCard();
+
+private:
+    /**
+     * 对局中不变的关卡布局
+     */
+    struct Layout
+    {
+        std::vector<CardCode> codes;
+        std::vector<cocos2d::Vec2> originalPositions;
+        std::vector<int> coverOffsets;
+        std::vector<int> coveredIds;
+        std::vector<int> stackOrder;
+        cocos2d::Vec2 trayPosition;
+    };
+    
+    /**
+     * 卡牌的可变状态
+     */
+    struct CardState
+    {
+        int16_t blockers;           // 压住它的在场卡牌数量
+        uint8_t zone;               // CardZone
+        uint8_t reserved;
+    };
+    
+    bool isCardIdValid(int cardId) const { return cardId >= 0 && cardId < static_cast<int>(_cards.size()); }
+    
+    // 修改卡牌区域并增量更新哈希
+    void setZone(int cardId, CardZone zone);
+    
+    // 卡牌成为新底牌，旧底牌离场
+    void setTrayCard(int cardId);
+    
+    std::shared_ptr<const Layout> _layout;          // 所有分支共享
+    PersistentArray<CardState> _cards;              // 下标即cardId
+    int _trayCardId;
+    size_t _stackSize;                              // 当前手牌堆为stackOrder的前缀
+    size_t _playfieldCount;
+    int _score;
+    uint64_t _zobristHash;
+};
+
+#endif // __PERSISTENT_GAME_MODEL_H__
@@ -1,10 +1,24 @@
 #include "UndoModel.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 USING_NS_CC;
 
 UndoModel::UndoModel()
-    : _maxUndoSteps(0)  // 0表示无限制
+    : _freeHead(kInvalidNode)
+    , _root(kInvalidNode)
+    , _current(kInvalidNode)
+    , _nodeCount(0)
+    , _nextSerial(0)
+    , _hasBranches(false)
+    , _maxUndoSteps(0)  // 0表示无限制
+    , _snapshotInterval(kDefaultSnapshotInterval)
+    , _snapshotStride(0)
+    , _snapshotCount(0)
 {
+    _nodes.reserve(kDefaultCapacity);
+    resetTree();
 }
 
 UndoModel::~UndoModel()
@@ -14,55 +28,539 @@ UndoModel::~UndoModel()
 
 void UndoModel::addUndoAction(const UndoAction& action)
 {
-    auto undoAction = std::make_shared<UndoAction>(action);
-    _undoActions.push_back(undoAction);
+    // 已有相同操作的分支时直接走进去，公共前缀只存一份
+    UndoNode& current = _nodes[_current];
+    for (int child = current.firstChild; child != kInvalidNode; child = _nodes[child].nextSibling)
+    {
+        if (_nodes[child].action == action)
+        {
+            enterChild(child);
+            return;
+        }
+    }
     
-    // 如果超出最大步数限制，移除最早的操作
-    if (_maxUndoSteps > 0 && _undoActions.size() > _maxUndoSteps)
+    if (current.firstChild != kInvalidNode)
     {
-        _undoActions.erase(_undoActions.begin());
+        _hasBranches = true;
     }
+    
+    int parent = _current;
+    int node = allocateNode();
+    UndoNode& created = _nodes[node];
+    created.action = action;
+    created.parent = parent;
+    created.depth = _nodes[parent].depth + 1;
+    created.nextSibling = _nodes[parent].firstChild;
+    _nodes[parent].firstChild = node;
+    
+    enterChild(node);
+    enforceBudget();
 }
 
-std::shared_ptr<UndoAction> UndoModel::getLastUndoAction()
+const UndoAction* UndoModel::getLastUndoAction() const
 {
-    if (_undoActions.empty())
+    if (!hasUndoActions())
         return nullptr;
     
-    return _undoActions.back();
+    return &_nodes[_current].action;
 }
 
 void UndoModel::removeLastUndoAction()
 {
-    if (!_undoActions.empty())
-    {
-        _undoActions.pop_back();
-    }
+    if (!hasUndoActions())
+        return;
+    
+    int parent = _nodes[_current].parent;
+    _nodes[parent].redoChild = _current;
+    _current = parent;
 }
 
 bool UndoModel::hasUndoActions() const
 {
-    return !_undoActions.empty();
+    return _current != _root;
 }
 
 size_t UndoModel::getUndoCount() const
 {
-    return _undoActions.size();
+    return static_cast<size_t>(_nodes[_current].depth - _nodes[_root].depth);
+}
+
+const UndoAction* UndoModel::getRedoAction() const
+{
+    int child = _nodes[_current].redoChild;
+    return child != kInvalidNode ? &_nodes[child].action : nullptr;
+}
+
+void UndoModel::advanceRedo()
+{
+    int child = _nodes[_current].redoChild;
+    if (child != kInvalidNode)
+    {
+        _current = child;
+    }
+}
+
+bool UndoModel::hasRedoActions() const
+{
+    return _nodes[_current].redoChild != kInvalidNode;
 }
 
 void UndoModel::clear()
 {
-    _undoActions.clear();
+    resetTree();
 }
 
 void UndoModel::setMaxUndoSteps(size_t maxSteps)
 {
     _maxUndoSteps = maxSteps;
+    enforceBudget();
+}
+
+bool UndoModel::isNodeValid(int node) const
+{
+    return node >= 0 && node < static_cast<int>(_nodes.size()) && _nodes[node].inUse;
+}
+
+int UndoModel::getNodeDepth(int node) const
+{
+    return _nodes[node].depth - _nodes[_root].depth;
+}
+
+void UndoModel::enterChild(int child)
+{
+    CCASSERT(isNodeValid(child) && _nodes[child].parent == _current, "enterChild expects a child of the current node");
+    _nodes[_current].redoChild = child;
+    _current = child;
+}
+
+void UndoModel::moveToNode(int node)
+{
+    CCASSERT(isNodeValid(node), "moveToNode expects a node in the tree");
+    _current = node;
+}
+
+void UndoModel::setSnapshotInterval(int interval)
+{
+    _snapshotInterval = std::max(interval, 0);
+    if (_snapshotInterval > 0)
+        return;
     
-    // 如果当前操作超过新的限制，移除多余的操作
-    if (_maxUndoSteps > 0 && _undoActions.size() > _maxUndoSteps)
+    for (int node = 0; node < static_cast<int>(_nodes.size()); ++node)
     {
-        size_t removeCount = _undoActions.size() - _maxUndoSteps;
-        _undoActions.erase(_undoActions.begin(), _undoActions.begin() + removeCount);
+        releaseSnapshot(node);
     }
+    _snapshotData.clear();
+    _freeSnapshots.clear();
+}
+
+bool UndoModel::needsSnapshot(int node) const
+{
+    // 按绝对深度取整，根节点后移时已有快照的间隔不变
+    return _snapshotInterval > 0
+        && _nodes[node].snapshot < 0
+        && _nodes[node].depth % _snapshotInterval == 0;
+}
+
+void UndoModel::storeSnapshot(int node, const GameModel& gameModel)
+{
+    size_t stride = 1 + gameModel.getLayoutWordCount();
+    if (_snapshotStride == 0)
+    {
+        _snapshotStride = stride;
+    }
+    CCASSERT(stride == _snapshotStride, "snapshot layout must match the level loaded when the history was started");
+    
+    releaseSnapshot(node);
+    
+    int slot;
+    if (!_freeSnapshots.empty())
+    {
+        slot = _freeSnapshots.back();
+        _freeSnapshots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<int>(_snapshotData.size() / _snapshotStride);
+        _snapshotData.resize(_snapshotData.size() + _snapshotStride);
+    }
+    
+    uint64_t* data = &_snapshotData[slot * _snapshotStride];
+    uint32_t stackSize = static_cast<uint32_t>(gameModel.getStackCards().size());
+    uint32_t trayCardId = static_cast<uint32_t>(gameModel.getTrayCardId());
+    data[0] = static_cast<uint64_t>(trayCardId) << 32 | stackSize;
+    std::copy(gameModel.getPlayfieldBits(), gameModel.getPlayfieldBits() + gameModel.getLayoutWordCount(), data + 1);
+    
+    _nodes[node].snapshot = slot;
+    ++_snapshotCount;
+}
+
+int UndoModel::findSnapshotNode(int node, int maxSteps) const
+{
+    for (int steps = 0; steps <= maxSteps && node != kInvalidNode; ++steps)
+    {
+        if (_nodes[node].snapshot >= 0)
+            return node;
+        node = _nodes[node].parent;
+    }
+    return kInvalidNode;
+}
+
+int UndoModel::countSnapshotChanges(int node, const GameModel& gameModel) const
+{
+    const uint64_t* data = &_snapshotData[_nodes[node].snapshot * _snapshotStride];
+    return gameModel.countLayoutChanges(data + 1, static_cast<int>(data[0] & 0xFFFFFFFFu), static_cast<int32_t>(data[0] >> 32));
+}
+
+void UndoModel::restoreSnapshot(int node, GameModel& gameModel) const
+{
+    CCASSERT(isNodeValid(node) && _nodes[node].snapshot >= 0, "restoreSnapshot expects a node with a snapshot");
+    
+    const uint64_t* data = &_snapshotData[_nodes[node].snapshot * _snapshotStride];
+    gameModel.restoreLayout(data + 1, static_cast<int>(data[0] & 0xFFFFFFFFu), static_cast<int32_t>(data[0] >> 32));
+}
+
+size_t UndoModel::getMemoryUsage() const
+{
+    return _nodes.capacity() * sizeof(UndoNode) + _snapshotData.capacity() * sizeof(uint64_t);
+}
+
+void UndoModel::exportHeader(GameSnapshotFormat::UndoHeader& header) const
+{
+    std::memset(&header, 0, sizeof(header));
+    header.freeHead = _freeHead;
+    header.root = _root;
+    header.current = _current;
+    header.nodeCount = static_cast<uint32_t>(_nodeCount);
+    header.nextSerial = _nextSerial;
+    header.maxUndoSteps = static_cast<uint32_t>(_maxUndoSteps);
+    header.snapshotInterval = _snapshotInterval;
+    header.snapshotStride = static_cast<uint32_t>(_snapshotStride);
+    header.snapshotCount = static_cast<uint32_t>(_snapshotCount);
+    header.hasBranches = _hasBranches ? 1 : 0;
+    header.hasUndo = 1;
+}
+
+bool UndoModel::importTree(const GameSnapshotFormat::UndoHeader& header, const void* nodes, size_t nodeCount, size_t nodeStride,
+                           const uint64_t* snapshots, size_t snapshotWords, const int32_t* freeSnapshots, size_t freeCount)
+{
+    resetTree();
+    if (nodeStride != sizeof(UndoNode) || nodeCount == 0)
+        return false;
+    
+    // 所有下标必须落在池内，否则存档损坏
+    int poolSize = static_cast<int>(nodeCount);
+    size_t snapshotSlots = header.snapshotStride > 0 ? snapshotWords / header.snapshotStride : 0;
+    auto inRange = [poolSize](int32_t node) { return node >= kInvalidNode && node < poolSize; };
+    
+    std::vector<UndoNode> imported(nodeCount);
+    std::memcpy(imported.data(), nodes, nodeCount * sizeof(UndoNode));
+    for (const UndoNode& node : imported)
+    {
+        // bool字段按原始字节检查，避免读到0/1以外的值
+        uint8_t inUse;
+        std::memcpy(&inUse, reinterpret_cast<const uint8_t*>(&node) + offsetof(UndoNode, inUse), sizeof(inUse));
+        if (inUse > 1)
+            return false;
+        
+        if (!inRange(node.parent) || !inRange(node.firstChild) || !inRange(node.nextSibling) || !inRange(node.redoChild)
+            || node.snapshot < -1 || node.snapshot >= static_cast<int32_t>(snapshotSlots))
+            return false;
+    }
+    if (!inRange(header.freeHead) || header.root < 0 || header.root >= poolSize || !imported[header.root].inUse
+        || header.current < 0 || header.current >= poolSize || !imported[header.current].inUse)
+        return false;
+    
+    // 快照池的每个格子要么被一个在用节点引用，要么在空闲列表中出现一次
+    if (header.snapshotStride > 0 ? snapshotWords % header.snapshotStride != 0 : snapshotWords != 0 || freeCount != 0)
+        return false;
+    
+    std::vector<uint8_t> slotUsed(snapshotSlots, 0);
+    size_t usedNodes = 0;
+    size_t usedSlots = 0;
+    for (const UndoNode& node : imported)
+    {
+        if (!node.inUse)
+            continue;
+        
+        ++usedNodes;
+        if (node.snapshot >= 0)
+        {
+            if (slotUsed[node.snapshot])
+                return false;
+            slotUsed[node.snapshot] = 1;
+            ++usedSlots;
+        }
+    }
+    for (size_t i = 0; i < freeCount; ++i)
+    {
+        int32_t slot = freeSnapshots[i];
+        if (slot < 0 || slot >= static_cast<int32_t>(snapshotSlots) || slotUsed[slot])
+            return false;
+        slotUsed[slot] = 1;
+    }
+    if (header.nodeCount != usedNodes || header.snapshotCount != usedSlots || usedSlots + freeCount != snapshotSlots)
+        return false;
+    
+    if (!checkTreeStructure(imported, header.root, header.current, header.freeHead, usedNodes))
+        return false;
+    
+    _nodes.swap(imported);
+    _freeHead = header.freeHead;
+    _root = header.root;
+    _current = header.current;
+    _nodeCount = header.nodeCount;
+    _nextSerial = header.nextSerial;
+    _hasBranches = header.hasBranches != 0;
+    _maxUndoSteps = header.maxUndoSteps;
+    _snapshotInterval = std::max(header.snapshotInterval, 0);
+    _snapshotStride = header.snapshotStride;
+    _snapshotData.assign(snapshots, snapshots + snapshotWords);
+    _freeSnapshots.assign(freeSnapshots, freeSnapshots + freeCount);
+    _snapshotCount = header.snapshotCount;
+    return true;
+}
+
+bool UndoModel::checkTreeStructure(const std::vector<UndoNode>& nodes, int root, int current, int freeHead, size_t usedNodes)
+{
+    // 调用前已确认所有下标在池内、root和current在用、在用节点数为usedNodes
+    size_t poolSize = nodes.size();
+    
+    // 空闲链表恰好串起所有空闲节点，并以-1结束（有环时走不到结尾）
+    size_t freeNodes = 0;
+    int node = freeHead;
+    for (; node != kInvalidNode && freeNodes < poolSize - usedNodes; node = nodes[node].nextSibling)
+    {
+        if (nodes[node].inUse)
+            return false;
+        ++freeNodes;
+    }
+    if (node != kInvalidNode || freeNodes != poolSize - usedNodes)
+        return false;
+    
+    // 每个非根在用节点恰好出现在其父节点的子节点链表中一次，深度比父节点大1
+    std::vector<uint8_t> linked(poolSize, 0);
+    for (size_t index = 0; index < poolSize; ++index)
+    {
+        const UndoNode& parent = nodes[index];
+        if (!parent.inUse)
+            continue;
+        
+        if (static_cast<int>(index) == root ? parent.parent != kInvalidNode : parent.parent == kInvalidNode)
+            return false;
+        
+        size_t children = 0;
+        for (int child = parent.firstChild; child != kInvalidNode; child = nodes[child].nextSibling)
+        {
+            const UndoNode& linkedChild = nodes[child];
+            if (!linkedChild.inUse || linkedChild.parent != static_cast<int>(index) || linked[child] || ++children >= usedNodes
+                || static_cast<int64_t>(linkedChild.depth) != static_cast<int64_t>(parent.depth) + 1)
+                return false;
+            linked[child] = 1;
+        }
+        
+        if (parent.redoChild != kInvalidNode && nodes[parent.redoChild].parent != static_cast<int>(index))
+            return false;
+    }
+    for (size_t index = 0; index < poolSize; ++index)
+    {
+        if (nodes[index].inUse && static_cast<int>(index) != root && !linked[index])
+            return false;
+    }
+    
+    // 当前节点沿父节点能走到根节点
+    size_t steps = 0;
+    for (node = current; node != root; node = nodes[node].parent)
+    {
+        if (node == kInvalidNode || ++steps >= usedNodes)
+            return false;
+    }
+    return true;
+}
+
+void UndoModel::releaseSnapshot(int node)
+{
+    if (_nodes[node].snapshot < 0)
+        return;
+    
+    _freeSnapshots.push_back(_nodes[node].snapshot);
+    _nodes[node].snapshot = -1;
+    --_snapshotCount;
+}
+
+int UndoModel::allocateNode()
+{
+    int node;
+    if (_freeHead != kInvalidNode)
+    {
+        node = _freeHead;
+        _freeHead = _nodes[node].nextSibling;
+    }
+    else
+    {
+        node = static_cast<int>(_nodes.size());
+        _nodes.push_back(UndoNode());
+    }
+    
+    UndoNode& created = _nodes[node];
+    created.action = UndoAction();
+    created.parent = kInvalidNode;
+    created.firstChild = kInvalidNode;
+    created.nextSibling = kInvalidNode;
+    created.redoChild = kInvalidNode;
+    created.depth = 0;
+    created.serial = _nextSerial++;
+    created.snapshot = -1;
+    created.inUse = true;
+    ++_nodeCount;
+    return node;
+}
+
+void UndoModel::releaseSubtree(int node)
+{
+    // 显式栈代替递归，路径可能很长
+    std::vector<int> pending(1, node);
+    while (!pending.empty())
+    {
+        int top = pending.back();
+        pending.pop_back();
+        
+        for (int child = _nodes[top].firstChild; child != kInvalidNode; child = _nodes[child].nextSibling)
+        {
+            pending.push_back(child);
+        }
+        
+        releaseSnapshot(top);
+        _nodes[top].inUse = false;
+        _nodes[top].firstChild = kInvalidNode;
+        _nodes[top].nextSibling = _freeHead;
+        _freeHead = top;
+        --_nodeCount;
+    }
+}
+
+void UndoModel::unlinkChild(int node)
+{
+    UndoNode& parent = _nodes[_nodes[node].parent];
+    if (parent.redoChild == node)
+    {
+        parent.redoChild = kInvalidNode;
+    }
+    
+    if (parent.firstChild == node)
+    {
+        parent.firstChild = _nodes[node].nextSibling;
+        return;
+    }
+    
+    for (int child = parent.firstChild; child != kInvalidNode; child = _nodes[child].nextSibling)
+    {
+        if (_nodes[child].nextSibling == node)
+        {
+            _nodes[child].nextSibling = _nodes[node].nextSibling;
+            return;
+        }
+    }
+}
+
+void UndoModel::enforceBudget()
+{
+    if (_maxUndoSteps == 0 || _nodeCount <= _maxUndoSteps)
+        return;
+    
+    // 先按创建先后淘汰不在当前路径上的分支，降到预算的3/4，避免每步都扫描
+    if (_hasBranches)
+    {
+        std::vector<bool> active;
+        markActivePath(active);
+        
+        // 不在当前路径上、父节点在当前路径上的节点即各个分支的根，整棵子树都不在当前路径上
+        std::vector<int> branches;
+        for (int node = 0; node < static_cast<int>(_nodes.size()); ++node)
+        {
+            if (_nodes[node].inUse && !active[node] && active[_nodes[node].parent])
+            {
+                branches.push_back(node);
+            }
+        }
+        std::sort(branches.begin(), branches.end(), [this](int a, int b) {
+            return _nodes[a].serial < _nodes[b].serial;
+        });
+        
+        size_t target = std::max<size_t>(_maxUndoSteps * 3 / 4, 1);
+        size_t evicted = 0;
+        while (evicted < branches.size() && _nodeCount > target)
+        {
+            unlinkChild(branches[evicted]);
+            releaseSubtree(branches[evicted]);
+            ++evicted;
+        }
+        
+        if (evicted == branches.size())
+        {
+            _hasBranches = false;
+        }
+    }
+    
+    // 只剩当前路径仍超出预算：丢弃最早的步骤
+    while (_nodeCount > _maxUndoSteps && _nodeCount > 1)
+    {
+        dropOldestStep();
+    }
+}
+
+void UndoModel::markActivePath(std::vector<bool>& active) const
+{
+    active.assign(_nodes.size(), false);
+    
+    for (int node = _current; node != kInvalidNode; node = _nodes[node].parent)
+    {
+        active[node] = true;
+    }
+    for (int node = _nodes[_current].redoChild; node != kInvalidNode; node = _nodes[node].redoChild)
+    {
+        active[node] = true;
+    }
+}
+
+void UndoModel::dropOldestStep()
+{
+    // 当前就在根节点（只剩重做链）时，丢弃重做链末端
+    if (_current == _root)
+    {
+        int last = _root;
+        while (_nodes[last].redoChild != kInvalidNode)
+        {
+            last = _nodes[last].redoChild;
+        }
+        unlinkChild(last);
+        releaseSubtree(last);
+        return;
+    }
+    
+    // 调用时所有分支已淘汰，根节点只有当前路径上的一个子节点，它成为新的根节点
+    int newRoot = _nodes[_root].firstChild;
+    CCASSERT(newRoot != kInvalidNode && _nodes[newRoot].nextSibling == kInvalidNode, "root must have a single child");
+    
+    _nodes[_root].firstChild = kInvalidNode;
+    releaseSubtree(_root);
+    
+    _root = newRoot;
+    _nodes[_root].parent = kInvalidNode;
+    _nodes[_root].action = UndoAction();
+}
+
+void UndoModel::resetTree()
+{
+    _nodes.clear();
+    _freeHead = kInvalidNode;
+    _nodeCount = 0;
+    _nextSerial = 0;
+    _hasBranches = false;
+    _snapshotStride = 0;
+    _snapshotData.clear();
+    _freeSnapshots.clear();
+    _snapshotCount = 0;
+    
+    _root = allocateNode();
+    _current = _root;
 }
@@ -3,13 +3,16 @@
 
 #include "cocos2d.h"
 #include "CardModel.h"
+#include "GameModel.h"
+#include "../utils/GameSnapshotFormat.h"
+#include <cstdint>
+#include <type_traits>
 #include <vector>
-#include <memory>
 
 /**
  * 回退操作类型
  */
-enum UndoActionType
+enum UndoActionType : uint8_t
 {
     UAT_MOVE_CARD,          // 移动卡牌
     UAT_REPLACE_TRAY,       // 替换底牌
@@ -18,43 +21,91 @@ enum UndoActionType
 
 /**
  * 单个回退操作记录
+ * 平凡可复制的定长记录，只保存操作类型和卡牌ID：
+ * 卡牌始终是卡牌池中的同一对象，回退时离开底牌的卡牌回到自身的初始位置
+ * （CardModel::getOriginalPosition），底牌位置由GameModel::getTrayPosition给出，因此不必记录坐标。
+ * 回退历史按值存放在节点池中，记录一步操作不做堆分配
  */
 struct UndoAction
 {
     UndoActionType actionType;                  // 操作类型
-    int cardId;                                 // 操作的卡牌ID
-    cocos2d::Vec2 fromPosition;                 // 起始位置
-    cocos2d::Vec2 toPosition;                   // 目标位置
-    std::shared_ptr<CardModel> previousTrayCard; // 之前的底牌（用于恢复）
+    int16_t cardId;                             // 操作的卡牌ID
+    int16_t previousTrayCardId;                 // 之前的底牌ID（用于恢复），-1表示没有
     
-    UndoAction(UndoActionType type, int id, const cocos2d::Vec2& from, const cocos2d::Vec2& to)
-        : actionType(type), cardId(id), fromPosition(from), toPosition(to) {}
+    static const int kMaxCardId = 32767;        // 可记录的最大卡牌ID
+    
+    UndoAction() = default;
+    
+    UndoAction(UndoActionType type, int id, int previousTrayId = -1)
+        : actionType(type), cardId(static_cast<int16_t>(id)), previousTrayCardId(static_cast<int16_t>(previousTrayId)) {}
+    
+    bool operator==(const UndoAction& other) const
+    {
+        return actionType == other.actionType && cardId == other.cardId && previousTrayCardId == other.previousTrayCardId;
+    }
+};
+
+static_assert(std::is_trivially_copyable<UndoAction>::value, "UndoAction must stay trivially copyable");
+
+/**
+ * 一次批量回退中单张卡牌的净位移
+ * 多步回退只为起止位置不同的卡牌生成一条记录，中间经过的位置不播放
+ */
+struct CardDisplacement
+{
+    int cardId;                 // 卡牌ID
+    cocos2d::Vec2 from;         // 批量回退前的位置
+    cocos2d::Vec2 to;           // 批量回退后的位置
 };
 
 /**
  * 回退数据模型
- * 管理游戏的撤销操作历史记录
+ * 管理游戏的撤销/重做历史树
+ *
+ * 每个节点表示一步操作，从根节点到某节点的路径就是到达该局面的操作序列，
+ * 不同分支共享公共前缀。当前节点之上的路径可以撤销；撤销后再走不同的操作会新建分支，
+ * 原分支保留，可以重做或跳转回去。
+ *
+ * 存储：
+ * - 节点是定长记录，存放在一块连续的节点池中，以下标互相引用（父节点、第一个子节点、下一个兄弟），
+ *   释放的节点挂到空闲链表上复用；节点池写满时按2倍扩容，记录一步操作均摊O(1)
+ * - 节点预算：节点数超出预算时，按创建先后淘汰不在当前路径（根到当前节点以及重做链）上的分支，
+ *   直到节点数降到预算的3/4；当前路径本身超出预算时丢弃最早的一步（无法再撤销到那里）
+ *
+ * 状态快照：
+ * - 深度为K的整数倍的节点另存一份完整局面（GameModel的紧凑局面：游戏区位集、手牌堆高度、底牌），
+ *   与操作记录并存，跳转到任意节点时可以恢复最近的祖先快照，再重放不超过K步操作
+ * - 快照是定长记录（1 + 卡牌数/64个uint64_t），存放在单独的快照池中，节点释放时一并回收
+ * - 恢复快照只移动与当前局面不同的卡牌，开销可以在恢复前算出，由调用方与逐步撤销/重放比较后选择
+ * - K越小回跳越快、占用内存越多；K为0时不保存快照，只能逐步撤销/重放
  */
 class UndoModel
 {
 public:
+    static const int kInvalidNode = -1;
+    static const size_t kDefaultCapacity = 64;      // 节点池初始容量
+    static const int kDefaultSnapshotInterval = 16; // 默认快照间隔（步数）
+    
     UndoModel();
     ~UndoModel();
     
+    // ==================== 撤销/重做 ====================
+    
     /**
-     * 添加撤销操作记录
+     * 添加撤销操作记录：在当前节点下新建子节点并移到该节点
+     * 当前节点已有相同操作的子节点时直接复用（重新走出已有分支）
      * @param action 操作记录
      */
     void addUndoAction(const UndoAction& action);
     
     /**
-     * 获取最近的撤销操作
-     * @return 最近的操作，如果无操作则返回nullptr
+     * 获取最近的撤销操作（当前节点的操作）
+     * @return 最近的操作，如果无操作则返回nullptr；下次修改历史前有效
      */
-    std::shared_ptr<UndoAction> getLastUndoAction();
+    const UndoAction* getLastUndoAction() const;
     
     /**
-     * 移除最近的撤销操作
+     * 移除最近的撤销操作：移到父节点，原节点保留为重做目标
      */
     void removeLastUndoAction();
     
@@ -65,25 +116,206 @@ public:
     bool hasUndoActions() const;
     
     /**
-     * 获取撤销栈的大小
+     * 获取撤销栈的大小（当前节点的深度）
      * @return 撤销操作的数量
      */
     size_t getUndoCount() const;
     
+    /**
+     * 获取重做操作（最近一次从当前节点撤销离开的子节点）
+     * @return 重做操作，没有时返回nullptr
+     */
+    const UndoAction* getRedoAction() const;
+    
+    /**
+     * 移到重做子节点
+     */
+    void advanceRedo();
+    
+    /**
+     * 检查是否有可重做的操作
+     */
+    bool hasRedoActions() const;
+    
     /**
      * 清空所有撤销操作
      */
     void clear();
     
     /**
-     * 设置最大撤销步数
-     * @param maxSteps 最大步数，0表示无限制
+     * 设置节点预算（包含所有分支的节点数）
+     * @param maxSteps 最大节点数，0表示无限制；没有分支时即最大撤销步数
      */
     void setMaxUndoSteps(size_t maxSteps);
+    
+    // ==================== 树访问 ====================
+    
+    // 根节点表示最早可回到的局面（不对应任何操作）；丢弃最早的步骤后根节点会后移
+    int getRootNode() const { return _root; }
+    int getCurrentNode() const { return _current; }
+    bool isNodeValid(int node) const;
+    int getParentNode(int node) const { return _nodes[node].parent; }
+    
+    // 节点相对根节点的深度（到达该节点需要的操作数）
+    int getNodeDepth(int node) const;
+    const UndoAction& getNodeAction(int node) const { return _nodes[node].action; }
+    
+    // 节点创建序号：节点被淘汰后下标会被复用，外部保存的节点下标需配合序号校验
+    uint32_t getNodeSerial(int node) const { return _nodes[node].serial; }
+    
+    /**
+     * 移到当前节点的某个子节点（重放该子节点的操作后调用）
+     */
+    void enterChild(int child);
+    
+    /**
+     * 当前节点数（含根节点）
+     */
+    size_t getNodeCount() const { return _nodeCount; }
+    
+    /**
+     * 跳到任意节点（调用方已把游戏局面恢复成该节点的局面，如恢复了该节点的快照）
+     */
+    void moveToNode(int node);
+    
+    // ==================== 状态快照 ====================
+    
+    /**
+     * 设置快照间隔
+     * @param interval 每隔多少步保存一份完整局面，0表示不保存（并释放已有快照）
+     */
+    void setSnapshotInterval(int interval);
+    int getSnapshotInterval() const { return _snapshotInterval; }
+    
+    /**
+     * 节点是否应保存快照：深度为间隔的整数倍且尚未保存
+     */
+    bool needsSnapshot(int node) const;
+    
+    /**
+     * 保存节点的快照
+     * @param node 节点，游戏模型当前必须处于该节点的局面
+     * @param gameModel 游戏模型
+     */
+    void storeSnapshot(int node, const GameModel& gameModel);
+    
+    /**
+     * 查找带快照的最近祖先（含节点本身）
+     * @param node 起始节点
+     * @param maxSteps 最多向上走的步数
+     * @return 带快照的节点，找不到时返回kInvalidNode
+     */
+    int findSnapshotNode(int node, int maxSteps) const;
+    
+    /**
+     * 恢复节点快照需要移动的卡牌数
+     */
+    int countSnapshotChanges(int node, const GameModel& gameModel) const;
+    
+    /**
+     * 把游戏模型恢复成节点快照中的局面（不移动当前节点，需再调用moveToNode）
+     */
+    void restoreSnapshot(int node, GameModel& gameModel) const;
+    
+    // 快照数量
+    size_t getSnapshotCount() const { return _snapshotCount; }
+    
+    // 节点池与快照池占用的内存（字节）
+    size_t getMemoryUsage() const;
+    
+    // ==================== 序列化 ====================
+    // 节点池与快照池是平凡可复制的定长记录，存档时原样按字节保存（见GameSnapshotService），
+    // 空闲节点一并保存，节点下标在存档前后保持不变
+    
+    // 导出标量部分
+    void exportHeader(GameSnapshotFormat::UndoHeader& header) const;
+    
+    // 节点池（含空闲节点）
+    const void* getNodeData() const { return _nodes.data(); }
+    size_t getNodePoolSize() const { return _nodes.size(); }
+    static size_t getNodeRecordSize() { return sizeof(UndoNode); }
+    
+    // 快照池及其空闲下标
+    const std::vector<uint64_t>& getSnapshotPool() const { return _snapshotData; }
+    const std::vector<int>& getFreeSnapshots() const { return _freeSnapshots; }
+    
+    /**
+     * 导入存档中的历史树，替换当前历史
+     * @param header 标量部分
+     * @param nodes 节点池记录
+     * @param nodeCount 节点池大小
+     * @param nodeStride 每条节点记录的字节数，与本机UndoNode不同时拒绝导入
+     * @param snapshots 快照池
+     * @param snapshotWords 快照池长度（uint64_t个数）
+     * @param freeSnapshots 快照池空闲下标
+     * @param freeCount 空闲下标个数
+     * @return 记录长度不符、下标越界、节点数或快照格子对不上、树结构损坏时返回false，历史被清空
+     */
+    bool importTree(const GameSnapshotFormat::UndoHeader& header, const void* nodes, size_t nodeCount, size_t nodeStride,
+                    const uint64_t* snapshots, size_t snapshotWords, const int32_t* freeSnapshots, size_t freeCount);
 
 private:
-    std::vector<std::shared_ptr<UndoAction>> _undoActions;  // 撤销操作栈
-    size_t _maxUndoSteps;                                   // 最大撤销步数限制
+    /**
+     * 树节点（平凡可复制，按下标引用）
+     */
+    struct UndoNode
+    {
+        UndoAction action;          // 到达该节点的操作（根节点无意义）
+        int32_t parent;             // 父节点，根节点为-1
+        int32_t firstChild;         // 第一个子节点
+        int32_t nextSibling;        // 下一个兄弟节点（空闲节点用作空闲链表）
+        int32_t redoChild;          // 重做目标：最近一次撤销离开的子节点
+        int32_t depth;              // 深度（绝对值，根节点后移时不用逐个更新）
+        uint32_t serial;            // 创建序号，越小越早
+        int32_t snapshot;           // 快照在快照池中的下标，-1表示没有
+        bool inUse;                 // 是否在树中
+    };
+    
+    static_assert(std::is_trivially_copyable<UndoNode>::value, "UndoNode must stay trivially copyable");
+    
+    // 分配/释放节点
+    int allocateNode();
+    void releaseSubtree(int node);
+    
+    /**
+     * 校验导入的节点池构成一棵树：空闲链表只串起空闲节点，父子链表互相一致、深度逐层加1，
+     * 重做目标是自己的子节点，当前节点能走到根节点；损坏的存档不会让遍历越界或死循环
+     */
+    static bool checkTreeStructure(const std::vector<UndoNode>& nodes, int root, int current, int freeHead, size_t usedNodes);
+    
+    // 从父节点的子节点链表中摘除
+    void unlinkChild(int node);
+    
+    // 超出预算时淘汰节点
+    void enforceBudget();
+    
+    // 标记当前路径（根到当前节点及重做链）上的节点
+    void markActivePath(std::vector<bool>& active) const;
+    
+    // 当前路径超出预算时丢弃最早的一步
+    void dropOldestStep();
+    
+    // 初始化为只有根节点
+    void resetTree();
+    
+    // 释放节点的快照
+    void releaseSnapshot(int node);
+    
+    std::vector<UndoNode> _nodes;                           // 节点池
+    int _freeHead;                                          // 空闲链表头
+    int _root;                                              // 根节点
+    int _current;                                           // 当前节点
+    size_t _nodeCount;                                      // 使用中的节点数
+    uint32_t _nextSerial;                                   // 下一个创建序号
+    bool _hasBranches;                                      // 是否可能存在不在当前路径上的节点
+    size_t _maxUndoSteps;                                   // 节点预算，0表示无限制
+    
+    // 快照池：每份快照占_snapshotStride个uint64_t，首个字的低32位为手牌堆高度、高32位为底牌ID，其后为游戏区位集
+    int _snapshotInterval;                                  // 快照间隔，0表示不保存
+    size_t _snapshotStride;                                 // 每份快照的长度（首次保存时按卡牌数确定）
+    std::vector<uint64_t> _snapshotData;                    // 快照池
+    std::vector<int> _freeSnapshots;                        // 空闲快照下标
+    size_t _snapshotCount;                                  // 使用中的快照数
 };
 
 #endif // __UNDO_MODEL_H__
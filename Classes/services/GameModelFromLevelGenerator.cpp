@@ -1,28 +1,34 @@
 #include "GameModelFromLevelGenerator.h"
+#include "../configs/models/CardResConfig.h"
+#include "../utils/CardCoverage.h"
 
 USING_NS_CC;
 
-int GameModelFromLevelGenerator::s_nextCardId = 1;
-
 GameModel* GameModelFromLevelGenerator::generateGameModel(const LevelConfig& levelConfig)
 {
     GameModel* gameModel = new GameModel();
     
+    // 一次性分配卡牌池，之后不再产生逐张卡牌的内存分配
+    gameModel->reserveCards(levelConfig.getPlayfieldCards().size() + levelConfig.getStackCards().size());
+    
     // 生成游戏区域卡牌
     generatePlayfieldCards(gameModel, levelConfig.getPlayfieldCards());
     
+    // 计算游戏区卡牌之间的覆盖关系
+    generateCoverage(gameModel, levelConfig.getPlayfieldCards());
+    
     // 生成手牌堆卡牌
     generateStackCards(gameModel, levelConfig.getStackCards());
     
     // 设置初始底牌（从手牌堆取第一张）
+    gameModel->setTrayPosition(Vec2(550, 400)); // 底牌区右移后位置
     if (!gameModel->isStackEmpty())
     {
         auto firstCard = gameModel->popStackCard();
         if (firstCard)
         {
-            // 将底牌位置调整到右移后的新位置
-            firstCard->setPosition(Vec2(550, 400)); // 底牌区右移后位置
-            gameModel->setTrayCard(firstCard);
+            firstCard->setPosition(gameModel->getTrayPosition());
+            gameModel->setTrayCard(firstCard->getCardId());
         }
     }
     
@@ -36,10 +42,8 @@ void GameModelFromLevelGenerator::generatePlayfieldCards(GameModel* gameModel, c
 {
     for (const auto& config : cardConfigs)
     {
-        int cardId = generateCardId();
-        auto card = std::make_shared<CardModel>(cardId, config.cardFace, config.cardSuit, config.position);
-        card->setOriginalPosition(config.position);
-        gameModel->addPlayfieldCard(card);
+        int cardId = gameModel->createCard(config.card, config.position);
+        gameModel->addPlayfieldCard(cardId);
     }
 }
 
@@ -50,18 +54,21 @@ void GameModelFromLevelGenerator::generateStackCards(GameModel* gameModel, const
     for (size_t i = 0; i < cardConfigs.size(); ++i)
     {
         const auto& config = cardConfigs[i];
-        int cardId = generateCardId();
         
         // 备用牌水平摊开显示，保持同一高度，增加重叠效果
         Vec2 cardPosition = baseStackPosition + Vec2(i * 30, 0); // 水平间距30像素，Y坐标相同
         
-        auto card = std::make_shared<CardModel>(cardId, config.cardFace, config.cardSuit, cardPosition);
-        card->setOriginalPosition(cardPosition);
-        gameModel->addStackCard(card);
+        int cardId = gameModel->createCard(config.card, cardPosition);
+        gameModel->addStackCard(cardId);
     }
 }
 
-int GameModelFromLevelGenerator::generateCardId()
+void GameModelFromLevelGenerator::generateCoverage(GameModel* gameModel, const std::vector<LevelConfig::CardConfig>& cardConfigs)
 {
-    return s_nextCardId++;
+    // 游戏区卡牌最先创建，cardId即配置下标
+    Size cardSize = CardResConfig::getCardSize();
+    CardCoverage::Graph graph = CardCoverage::build(static_cast<int>(cardConfigs.size()), cardSize.width, cardSize.height,
+        [&cardConfigs](int index) { return cardConfigs[index].position; });
+    
+    gameModel->setCoverage(graph.offsets, graph.coveredIds);
 }
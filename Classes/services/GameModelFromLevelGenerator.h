@@ -18,7 +18,7 @@ public:
      * @return 生成的游戏模型，调用方负责内存管理
      */
     static GameModel* generateGameModel(const LevelConfig& levelConfig);
-    
+
 private:
     /**
      * 生成游戏区域卡牌
@@ -35,13 +35,12 @@ private:
     static void generateStackCards(GameModel* gameModel, const std::vector<LevelConfig::CardConfig>& cardConfigs);
     
     /**
-     * 生成唯一的卡牌ID
-     * @return 唯一的卡牌ID
+     * 根据游戏区卡牌位置计算覆盖关系
+     * 后放置的卡牌绘制在上层，与先放置的卡牌矩形（CardResConfig::kCardSize）重叠时压住它
+     * @param gameModel 游戏模型（游戏区卡牌ID与配置顺序一致）
+     * @param cardConfigs 游戏区卡牌配置列表
      */
-    static int generateCardId();
-    
-private:
-    static int s_nextCardId;    // 下一个卡牌ID
+    static void generateCoverage(GameModel* gameModel, const std::vector<LevelConfig::CardConfig>& cardConfigs);
 };
 
 #endif // __GAME_MODEL_FROM_LEVEL_GENERATOR_H__
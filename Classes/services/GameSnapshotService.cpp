@@ -0,0 +1,303 @@
+#include "GameSnapshotService.h"
+#include <cstdio>
+#include <cstring>
+
+USING_NS_CC;
+
+using namespace GameSnapshotFormat;
+
+static_assert(sizeof(int) == sizeof(int32_t), "card id lists are stored as int32_t");
+
+GameSnapshotView::GameSnapshotView()
+    : _data(nullptr)
+    , _size(0)
+{
+}
+
+bool GameSnapshotView::open(const void* data, size_t size)
+{
+    _data = nullptr;
+    _size = 0;
+    
+    // 段按8字节对齐访问，存档首地址也必须对齐（mmap和堆分配的缓冲区都满足）
+    if (!data || size < sizeof(FileHeader) || reinterpret_cast<uintptr_t>(data) % kAlignment != 0)
+        return false;
+    
+    const FileHeader* header = static_cast<const FileHeader*>(data);
+    if (header->magic != kMagic || header->version != kVersion || header->headerSize != sizeof(FileHeader)
+        || header->totalSize < sizeof(FileHeader) || header->totalSize > size)
+        return false;
+    
+    for (const Section& section : header->sections)
+    {
+        uint64_t end = static_cast<uint64_t>(section.offset) + static_cast<uint64_t>(section.count) * section.stride;
+        if (section.offset % kAlignment != 0 || section.offset < sizeof(FileHeader) || end > header->totalSize)
+            return false;
+    }
+    
+    _data = static_cast<const uint8_t*>(data);
+    _size = header->totalSize;
+    return true;
+}
+
+const FileHeader& GameSnapshotView::getHeader() const
+{
+    CCASSERT(_data, "GameSnapshotView: snapshot is not open");
+    return *reinterpret_cast<const FileHeader*>(_data);
+}
+
+size_t GameSnapshotView::getCount(SectionId section) const
+{
+    return getHeader().sections[section].count;
+}
+
+size_t GameSnapshotView::getStride(SectionId section) const
+{
+    return getHeader().sections[section].stride;
+}
+
+const void* GameSnapshotView::getData(SectionId section) const
+{
+    return _data + getHeader().sections[section].offset;
+}
+
+void GameSnapshotService::save(const GameModel& gameModel, const UndoModel* undoModel, std::vector<uint8_t>& out)
+{
+    // 各段的来源与布局，卡牌段逐张填写，其余段整段复制
+    const void* sources[GSS_SECTION_COUNT] = {};
+    Section sections[GSS_SECTION_COUNT] = {};
+    auto describe = [&](SectionId id, const void* source, size_t count, size_t stride) {
+        sources[id] = source;
+        sections[id].count = static_cast<uint32_t>(count);
+        sections[id].stride = static_cast<uint32_t>(stride);
+    };
+    
+    describe(GSS_CARDS, nullptr, gameModel.getCardCount(), sizeof(CardRecord));
+    describe(GSS_PLAYFIELD, gameModel.getPlayfieldCards().data(), gameModel.getPlayfieldCards().size(), sizeof(int32_t));
+    describe(GSS_STACK_ORDER, gameModel.getStackOrder().data(), gameModel.getStackOrder().size(), sizeof(int32_t));
+    describe(GSS_COVER_OFFSETS, gameModel.getCoverOffsets().data(), gameModel.getCoverOffsets().size(), sizeof(int32_t));
+    describe(GSS_COVERED_IDS, gameModel.getCoveredIds().data(), gameModel.getCoveredIds().size(), sizeof(int32_t));
+    if (undoModel)
+    {
+        describe(GSS_UNDO_NODES, undoModel->getNodeData(), undoModel->getNodePoolSize(), UndoModel::getNodeRecordSize());
+        describe(GSS_UNDO_SNAPSHOTS, undoModel->getSnapshotPool().data(), undoModel->getSnapshotPool().size(), sizeof(uint64_t));
+        describe(GSS_UNDO_FREE_SNAPSHOTS, undoModel->getFreeSnapshots().data(), undoModel->getFreeSnapshots().size(), sizeof(int32_t));
+    }
+    
+    uint32_t totalSize = sizeof(FileHeader);
+    for (Section& section : sections)
+    {
+        section.offset = totalSize;
+        totalSize = align(totalSize + section.count * section.stride);
+    }
+    
+    // 一次分配，对齐填充为0
+    out.assign(totalSize, 0);
+    
+    FileHeader* header = reinterpret_cast<FileHeader*>(out.data());
+    header->magic = kMagic;
+    header->version = kVersion;
+    header->headerSize = sizeof(FileHeader);
+    header->totalSize = totalSize;
+    std::memcpy(header->sections, sections, sizeof(sections));
+    
+    ModelHeader& model = header->model;
+    model.trayCardId = gameModel.getTrayCardId();
+    model.trayX = gameModel.getTrayPosition().x;
+    model.trayY = gameModel.getTrayPosition().y;
+    model.score = gameModel.getScore();
+    model.stackSize = static_cast<uint32_t>(gameModel.getStackCards().size());
+    model.gameActive = gameModel.isGameActive() ? 1 : 0;
+    model.zobristHash = gameModel.getZobristHash();
+    
+    if (undoModel)
+    {
+        undoModel->exportHeader(header->undo);
+    }
+    
+    for (int id = 0; id < GSS_SECTION_COUNT; ++id)
+    {
+        if (sources[id] && sections[id].count > 0)
+        {
+            std::memcpy(out.data() + sections[id].offset, sources[id], sections[id].count * sections[id].stride);
+        }
+    }
+    
+    CardRecord* cards = reinterpret_cast<CardRecord*>(out.data() + sections[GSS_CARDS].offset);
+    for (size_t cardId = 0; cardId < gameModel.getCardCount(); ++cardId)
+    {
+        const CardModel* card = gameModel.getCard(static_cast<int>(cardId));
+        CardRecord& record = cards[cardId];
+        record.x = card->getPosition().x;
+        record.y = card->getPosition().y;
+        record.originalX = card->getOriginalPosition().x;
+        record.originalY = card->getOriginalPosition().y;
+        record.code = card->getCode().bits;
+        record.visible = card->isVisible() ? 1 : 0;
+    }
+}
+
+bool GameSnapshotService::saveToFile(const std::string& path, const GameModel& gameModel, const UndoModel* undoModel)
+{
+    std::vector<uint8_t> buffer;
+    save(gameModel, undoModel, buffer);
+    
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        CCLOG("GameSnapshotService: cannot write %s", path.c_str());
+        return false;
+    }
+    
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = std::fclose(file) == 0 && written;
+    return written;
+}
+
+GameModel* GameSnapshotService::load(const GameSnapshotView& view, UndoModel* undoModel)
+{
+    if (!view.isValid())
+        return nullptr;
+    
+    // 记录长度与本机布局一致才能原地读取
+    const SectionId intSections[] = { GSS_PLAYFIELD, GSS_STACK_ORDER, GSS_COVER_OFFSETS, GSS_COVERED_IDS, GSS_UNDO_FREE_SNAPSHOTS };
+    for (SectionId id : intSections)
+    {
+        if (view.getCount(id) > 0 && view.getStride(id) != sizeof(int32_t))
+            return nullptr;
+    }
+    if (view.getStride(GSS_CARDS) != sizeof(CardRecord)
+        || (view.getCount(GSS_UNDO_SNAPSHOTS) > 0 && view.getStride(GSS_UNDO_SNAPSHOTS) != sizeof(uint64_t)))
+        return nullptr;
+    
+    const FileHeader& header = view.getHeader();
+    const ModelHeader& model = header.model;
+    size_t cardCount = view.getCount(GSS_CARDS);
+    const int32_t* playfield = view.get<int32_t>(GSS_PLAYFIELD);
+    const int32_t* stackOrder = view.get<int32_t>(GSS_STACK_ORDER);
+    const int32_t* coverOffsets = view.get<int32_t>(GSS_COVER_OFFSETS);
+    const int32_t* coveredIds = view.get<int32_t>(GSS_COVERED_IDS);
+    size_t coverOffsetCount = view.getCount(GSS_COVER_OFFSETS);
+    size_t coveredCount = view.getCount(GSS_COVERED_IDS);
+    
+    // 卡牌ID不越界，游戏区与手牌堆初始顺序互不重叠
+    std::vector<uint8_t> seen(cardCount, 0);
+    if (!checkCardIds(playfield, view.getCount(GSS_PLAYFIELD), seen)
+        || !checkCardIds(stackOrder, view.getCount(GSS_STACK_ORDER), seen)
+        || model.stackSize > view.getCount(GSS_STACK_ORDER)
+        || model.trayCardId < -1 || model.trayCardId >= static_cast<int32_t>(cardCount)
+        || coverOffsetCount > cardCount + 1)
+        return nullptr;
+    
+    // 覆盖关系：偏移单调且不越界，被压住的卡牌ID不越界
+    for (size_t i = 0; i < coverOffsetCount; ++i)
+    {
+        if (coverOffsets[i] < (i > 0 ? coverOffsets[i - 1] : 0) || coverOffsets[i] > static_cast<int32_t>(coveredCount))
+            return nullptr;
+    }
+    for (size_t i = 0; i < coveredCount; ++i)
+    {
+        if (coveredIds[i] < 0 || coveredIds[i] >= static_cast<int32_t>(cardCount))
+            return nullptr;
+    }
+    
+    GameModel* gameModel = new GameModel();
+    gameModel->reserveCards(cardCount);
+    
+    const CardRecord* cards = view.get<CardRecord>(GSS_CARDS);
+    for (size_t cardId = 0; cardId < cardCount; ++cardId)
+    {
+        gameModel->createCard(CardCode::fromBits(cards[cardId].code), Vec2(cards[cardId].originalX, cards[cardId].originalY));
+    }
+    
+    gameModel->setCoverage(std::vector<int>(coverOffsets, coverOffsets + coverOffsetCount),
+                           std::vector<int>(coveredIds, coveredIds + coveredCount));
+    gameModel->setPlayfieldCards(std::vector<int>(playfield, playfield + view.getCount(GSS_PLAYFIELD)));
+    gameModel->setStackCards(std::vector<int>(stackOrder, stackOrder + view.getCount(GSS_STACK_ORDER)));
+    while (gameModel->getStackCards().size() > model.stackSize)
+    {
+        gameModel->popStackCard();
+    }
+    gameModel->setTrayPosition(Vec2(model.trayX, model.trayY));
+    gameModel->setTrayCard(model.trayCardId);
+    
+    for (size_t cardId = 0; cardId < cardCount; ++cardId)
+    {
+        CardModel* card = gameModel->getCard(static_cast<int>(cardId));
+        card->setPosition(Vec2(cards[cardId].x, cards[cardId].y));
+        card->setVisible(cards[cardId].visible != 0);
+    }
+    
+    gameModel->setScore(model.score);
+    gameModel->setGameActive(model.gameActive != 0);
+    
+    // 重建出的局面必须与保存时一致（底牌同时在游戏区或手牌堆等情况在这里发现）
+    if (gameModel->getZobristHash() != model.zobristHash || gameModel->computeZobristHash() != model.zobristHash)
+    {
+        CCLOG("GameSnapshotService: snapshot does not rebuild the saved position");
+        delete gameModel;
+        return nullptr;
+    }
+    
+    if (undoModel)
+    {
+        // 状态快照的长度由卡牌数决定，与重建出的模型不符时快照不可用
+        const UndoHeader& undo = header.undo;
+        bool snapshotsMatch = undo.snapshotStride == 0
+            || (undo.snapshotStride == 1 + gameModel->getLayoutWordCount() && view.getCount(GSS_UNDO_SNAPSHOTS) % undo.snapshotStride == 0);
+        
+        if (!undo.hasUndo)
+        {
+            undoModel->clear();
+        }
+        else if (!snapshotsMatch
+                 || !undoModel->importTree(undo, view.getData(GSS_UNDO_NODES), view.getCount(GSS_UNDO_NODES),
+                                           view.getStride(GSS_UNDO_NODES), view.get<uint64_t>(GSS_UNDO_SNAPSHOTS),
+                                           view.getCount(GSS_UNDO_SNAPSHOTS), view.get<int32_t>(GSS_UNDO_FREE_SNAPSHOTS),
+                                           view.getCount(GSS_UNDO_FREE_SNAPSHOTS)))
+        {
+            CCLOG("GameSnapshotService: undo history in snapshot is corrupt");
+            delete gameModel;
+            return nullptr;
+        }
+    }
+    
+    return gameModel;
+}
+
+GameModel* GameSnapshotService::loadFromFile(const std::string& path, UndoModel* undoModel)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return nullptr;
+    
+    // 整个文件一次读入（堆缓冲区满足8字节对齐），再在缓冲区上原地解析
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    
+    std::vector<uint64_t> buffer(size > 0 ? (static_cast<size_t>(size) + 7) / 8 : 0);
+    bool read = size > 0 && std::fread(buffer.data(), 1, static_cast<size_t>(size), file) == static_cast<size_t>(size);
+    std::fclose(file);
+    if (!read)
+        return nullptr;
+    
+    GameSnapshotView view;
+    if (!view.open(buffer.data(), static_cast<size_t>(size)))
+    {
+        CCLOG("GameSnapshotService: %s is not a valid snapshot", path.c_str());
+        return nullptr;
+    }
+    return load(view, undoModel);
+}
+
+bool GameSnapshotService::checkCardIds(const int32_t* cardIds, size_t count, std::vector<uint8_t>& seen)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (cardIds[i] < 0 || cardIds[i] >= static_cast<int32_t>(seen.size()) || seen[cardIds[i]])
+            return false;
+        seen[cardIds[i]] = 1;
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file GameSnapshotService.h
+ * @brief 游戏存档服务头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把游戏模型和撤销历史保存为版本化的紧凑二进制存档，用于保存、恢复和传输对局
+ */
+
+#ifndef __GAME_SNAPSHOT_SERVICE_H__
+#define __GAME_SNAPSHOT_SERVICE_H__
+
+#include "cocos2d.h"
+#include "../models/GameModel.h"
+#include "../models/UndoModel.h"
+#include "../utils/GameSnapshotFormat.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class GameSnapshotView
+ * @brief 存档只读视图
+ *
+ * 在一块存档内存（mmap的文件或读入的缓冲区）上原地访问文件头和各段，不复制数据；
+ * open时一次性校验魔数、版本、各段边界与对齐，之后的访问不再检查
+ */
+class GameSnapshotView
+{
+public:
+    GameSnapshotView();
+    
+    /**
+     * 绑定存档内存
+     * @param data 存档首地址，需8字节对齐，视图使用期间必须保持有效
+     * @param size 存档字节数
+     * @return 格式不符或越界时返回false
+     */
+    bool open(const void* data, size_t size);
+    
+    bool isValid() const { return _data != nullptr; }
+    
+    const GameSnapshotFormat::FileHeader& getHeader() const;
+    
+    // 段的记录数与记录长度
+    size_t getCount(GameSnapshotFormat::SectionId section) const;
+    size_t getStride(GameSnapshotFormat::SectionId section) const;
+    
+    // 段首地址（原地访问）
+    const void* getData(GameSnapshotFormat::SectionId section) const;
+    
+    template <typename T>
+    const T* get(GameSnapshotFormat::SectionId section) const
+    {
+        return static_cast<const T*>(getData(section));
+    }
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+};
+
+/**
+ * @class GameSnapshotService
+ * @brief 游戏存档服务
+ *
+ * 存档内容：
+ * - 卡牌池（点数花色编码、当前位置、初始位置、可见性）、游戏区顺序、手牌堆初始顺序与当前高度、
+ *   覆盖关系邻接表、底牌、得分，以及局面Zobrist哈希
+ * - 撤销历史的节点池和状态快照池按原样保存，节点下标不变
+ * - 翻开状态、位棋盘、区域索引等派生数据不保存，加载时由GameModel重建，再与存档中的哈希比对
+ *
+ * 保存先算出总长度，一次分配缓冲区、逐段memcpy，写文件只调用一次fwrite；
+ * 加载在视图上原地读取各段，只在建立模型自身的容器时整段复制
+ */
+class GameSnapshotService
+{
+public:
+    /**
+     * 保存存档到内存
+     * @param gameModel 游戏模型
+     * @param undoModel 撤销历史，为nullptr时不保存
+     * @param out 输出缓冲区，原有内容被替换（可复用以避免重复分配）
+     */
+    static void save(const GameModel& gameModel, const UndoModel* undoModel, std::vector<uint8_t>& out);
+    
+    /**
+     * 保存存档到文件
+     * @return 文件无法写入时返回false
+     */
+    static bool saveToFile(const std::string& path, const GameModel& gameModel, const UndoModel* undoModel);
+    
+    /**
+     * 从存档视图生成游戏模型
+     * @param view 已打开的存档视图
+     * @param undoModel 撤销历史，不为nullptr时替换为存档中的历史（存档中没有时清空）
+     * @return 生成的游戏模型，调用方负责内存管理；存档内容不一致时返回nullptr
+     */
+    static GameModel* load(const GameSnapshotView& view, UndoModel* undoModel);
+    
+    /**
+     * 从文件加载存档
+     * @return 文件无法读取或内容不一致时返回nullptr
+     */
+    static GameModel* loadFromFile(const std::string& path, UndoModel* undoModel);
+
+private:
+    // 校验卡牌ID列表：不越界、不重复出现在多个区域
+    static bool checkCardIds(const int32_t* cardIds, size_t count, std::vector<uint8_t>& seen);
+};
+
+#endif // __GAME_SNAPSHOT_SERVICE_H__
@@ -0,0 +1,139 @@
+#include "HintService.h"
+#include "cocos2d.h"
+#include <chrono>
+
+USING_NS_CC;
+
+namespace
+{
+    // 提示搜索的置换表大小（2^16项，约1MB）
+    const int kHintTableBits = 16;
+}
+
+HintService::HintService(int budgetMs)
+    : _budgetMs(budgetMs)
+    , _generation(std::make_shared<std::atomic<uint32_t>>(0))
+    , _solver(kHintTableBits)
+    , _hasRequest(false)
+    , _quit(false)
+    , _requestGeneration(0)
+    , _worker(&HintService::workerLoop, this)
+{
+}
+
+HintService::~HintService()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+        _hasRequest = false;
+    }
+    cancel();
+    _condition.notify_one();
+    _worker.join();
+}
+
+void HintService::requestHint(const GameModel& gameModel, const HintCallback& callback)
+{
+    const GameState& state = gameModel.getGameState();
+    if (!state.isValid())
+    {
+        CCLOG("HintService: level exceeds bitboard capacity, no hint");
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requestState = state;
+        _requestCallback = callback;
+        _requestGeneration = _generation->fetch_add(1) + 1;
+        _hasRequest = true;
+    }
+    _condition.notify_one();
+}
+
+void HintService::cancel()
+{
+    _generation->fetch_add(1);
+}
+
+void HintService::workerLoop()
+{
+    for (;;)
+    {
+        GameState state;
+        HintCallback callback;
+        uint32_t generation;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _quit || _hasRequest; });
+            if (_quit)
+                break;
+            
+            state = _requestState;
+            callback = _requestCallback;
+            generation = _requestGeneration;
+            _hasRequest = false;
+        }
+        
+        HintResult result = computeHint(state, generation);
+        if (_generation->load() != generation)
+            continue;
+        
+        // 回调前在主线程再次检查代数：投递后玩家仍可能走牌或回退
+        std::shared_ptr<std::atomic<uint32_t>> currentGeneration = _generation;
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(
+            [currentGeneration, generation, callback, result]() {
+                if (currentGeneration->load() == generation && callback)
+                {
+                    callback(result);
+                }
+            });
+    }
+}
+
+HintResult HintService::computeHint(const GameState& state, uint32_t generation)
+{
+    HintResult result;
+    
+    // 启发式走法：与求解器相同的走法排序，第一步即优先移走压住更多卡牌的匹配
+    uint64_t matchable = state.getMatchableMask();
+    GameMove moves[LevelSolver::kMaxMoves];
+    int moveCount = LevelSolver::generateOrderedMoves(state, matchable, moves);
+    if (moveCount == 0)
+        return result;
+    
+    result.cardId = moveToCardId(state, moves[0]);
+    
+    // 在预算内求解，代数改变或超时即中止
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_budgetMs.load());
+    std::shared_ptr<std::atomic<uint32_t>> currentGeneration = _generation;
+    _solver.setStopCheck([currentGeneration, generation, deadline]() {
+        return currentGeneration->load(std::memory_order_relaxed) != generation
+            || std::chrono::steady_clock::now() >= deadline;
+    });
+    
+    SolverResult solved = _solver.solve(state);
+    result.nodes = solved.nodes;
+    
+    if (solved.solvable && !solved.line.empty())
+    {
+        result.cardId = moveToCardId(state, solved.line.front());
+        result.winning = true;
+    }
+    else if (solved.complete && !solved.solvable)
+    {
+        result.deadEnd = true;
+    }
+    
+    return result;
+}
+
+int HintService::moveToCardId(const GameState& state, const GameMove& move)
+{
+    // 游戏区卡牌的位即卡牌ID
+    if (move.type == GMT_MATCH)
+        return move.bit;
+    
+    return state.getStackCardId(state.getStackSize() - 1);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file HintService.h
+ * @brief 异步提示服务头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 在工作线程上为当前局面搜索推荐走法，不占用cocos主线程的帧时间
+ */
+
+#ifndef __HINT_SERVICE_H__
+#define __HINT_SERVICE_H__
+
+#include "../models/GameModel.h"
+#include "LevelSolver.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * 提示结果
+ */
+struct HintResult
+{
+    int cardId;             // 推荐点击的卡牌ID（游戏区卡牌或手牌堆顶部卡牌），-1表示无路可走
+    bool winning;           // 该走法在已找到的通关走法上
+    bool deadEnd;           // 已证明当前局面无法通关（仍给出一步可走的走法）
+    uint64_t nodes;         // 搜索的节点数
+    
+    HintResult() : cardId(-1), winning(false), deadEnd(false), nodes(0) {}
+};
+
+/**
+ * @class HintService
+ * @brief 异步提示服务
+ *
+ * 工作流程：
+ * - requestHint在主线程复制当前位棋盘局面，交给工作线程后立即返回
+ * - 工作线程先按走法排序给出启发式走法，再在时间预算内用LevelSolver求解，
+ *   求解完成时以通关走法的第一步替换启发式走法（随时可中止的anytime搜索）
+ * - 预算用尽或求解结束后，通过Scheduler::performFunctionInCocosThread把结果交回主线程回调
+ * - 每次请求和cancel都会递增代数，旧代数的搜索在下一次中止检查时退出，结果也不会回调
+ *
+ * 使用说明：
+ * - 玩家走牌、回退、切换关卡时调用cancel
+ * - 超出位棋盘容量（游戏区多于64张）的关卡不提供提示
+ */
+class HintService
+{
+public:
+    typedef std::function<void(const HintResult&)> HintCallback;
+    
+    static const int kDefaultBudgetMs = 200;    // 默认搜索时间预算（毫秒）
+    
+    /**
+     * @param budgetMs 每次请求的搜索时间预算（毫秒）
+     */
+    explicit HintService(int budgetMs = kDefaultBudgetMs);
+    
+    /**
+     * @brief 析构函数，取消未完成的请求并等待工作线程退出
+     */
+    ~HintService();
+    
+    /**
+     * @brief 请求提示（在主线程调用），取消尚未完成的旧请求
+     * @param gameModel 当前游戏模型，调用时复制其局面
+     * @param callback 结果回调，在主线程执行；请求被取消时不会调用
+     */
+    void requestHint(const GameModel& gameModel, const HintCallback& callback);
+    
+    /**
+     * @brief 取消未完成的请求
+     */
+    void cancel();
+    
+    /**
+     * @brief 设置搜索时间预算
+     */
+    void setBudgetMs(int budgetMs) { _budgetMs = budgetMs; }
+    int getBudgetMs() const { return _budgetMs; }
+
+private:
+    // 工作线程主循环
+    void workerLoop();
+    
+    /**
+     * @brief 计算提示
+     * @param state 请求时的局面
+     * @param generation 请求代数，代数改变时中止搜索
+     */
+    HintResult computeHint(const GameState& state, uint32_t generation);
+    
+    // 把走法转换为要点击的卡牌ID
+    static int moveToCardId(const GameState& state, const GameMove& move);
+    
+    std::atomic<int> _budgetMs;                             // 搜索时间预算（毫秒）
+    std::shared_ptr<std::atomic<uint32_t>> _generation;     // 请求代数（与投递到主线程的回调共享）
+    LevelSolver _solver;                                    // 求解器（只在工作线程使用）
+    
+    std::mutex _mutex;                                      // 保护以下请求数据
+    std::condition_variable _condition;                     // 通知工作线程有新请求或退出
+    bool _hasRequest;                                       // 是否有待处理请求
+    bool _quit;                                             // 是否退出工作线程
+    GameState _requestState;                                // 请求的局面
+    HintCallback _requestCallback;                          // 请求的回调
+    uint32_t _requestGeneration;                            // 请求的代数
+    
+    std::thread _worker;                                    // 工作线程（最后初始化）
+};
+
+#endif // __HINT_SERVICE_H__
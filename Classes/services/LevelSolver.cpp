@@ -0,0 +1,254 @@
+#include "LevelSolver.h"
+#include "../utils/CardCoverage.h"
+#include "../utils/Zobrist.h"
+#include <algorithm>
+#include <bitset>
+
+namespace
+{
+    int countBits(uint64_t mask)
+    {
+        return static_cast<int>(std::bitset<64>(mask).count());
+    }
+}
+
+LevelSolver::LevelSolver(int ttBits)
+    : _tableMask(0)
+    , _nodes(0)
+    , _maxNodes(0)
+    , _aborted(false)
+{
+    if (ttBits < 10)
+        ttBits = 10;
+    if (ttBits > 28)
+        ttBits = 28;
+    
+    _table.resize(static_cast<size_t>(1) << ttBits);
+    _tableMask = _table.size() - 1;
+}
+
+bool LevelSolver::buildState(const SolverLevel& level, GameState& state)
+{
+    state.reset();
+    
+    int playfieldCount = static_cast<int>(level.playfield.size());
+    if (playfieldCount > GameState::kMaxPlayfieldCards || level.stack.size() > GameState::kMaxStackCards)
+    {
+        state.invalidate();
+        return false;
+    }
+    
+    // 游戏区卡牌ID与放置顺序一致
+    for (int bit = 0; bit < playfieldCount; ++bit)
+    {
+        state.registerPlayfieldCard(bit, level.playfield[bit].code);
+        state.setPlayfieldPresent(bit, true);
+    }
+    
+    CardCoverage::Graph graph = CardCoverage::build(playfieldCount, level.cardWidth, level.cardHeight,
+        [&level](int index) { return level.playfield[index]; });
+    for (int blocker = 0; blocker < playfieldCount; ++blocker)
+    {
+        for (int i = graph.offsets[blocker]; i < graph.offsets[blocker + 1]; ++i)
+        {
+            state.addCover(blocker, graph.coveredIds[i]);
+        }
+    }
+    state.refreshExposure();
+    
+    // 手牌堆卡牌ID紧随游戏区，顶部一张翻到底牌
+    for (size_t i = 0; i < level.stack.size(); ++i)
+    {
+        state.pushStackCard(playfieldCount + static_cast<int>(i), level.stack[i]);
+    }
+    
+    if (state.canDraw())
+    {
+        int top = state.getStackSize() - 1;
+        state.setTray(state.getStackCardId(top), state.getStackCode(top));
+        state.popStackCard();
+    }
+    
+    return state.isValid();
+}
+
+SolverResult LevelSolver::solve(const GameState& initial, uint64_t maxNodes)
+{
+    SolverResult result;
+    if (!initial.isValid())
+        return result;
+    
+    std::fill(_table.begin(), _table.end(), TTEntry());
+    _line.clear();
+    _nodes = 0;
+    _maxNodes = maxNodes;
+    _aborted = false;
+    
+    buildStackFaces(initial, _stackFaces);
+    
+    // 每轮搜索失败时返回已证明的步数下界，下一轮直接加深到该下界
+    GameState state = initial;
+    int depth = lowerBound(state, state.getMatchableMask(), _stackFaces);
+    while (!_aborted && depth < kUnsolvable)
+    {
+        int bound = search(state, depth);
+        if (bound == kSolved)
+        {
+            result.solvable = true;
+            result.line = _line;
+            break;
+        }
+        depth = bound;
+    }
+    
+    result.complete = !_aborted;
+    result.nodes = _nodes;
+    return result;
+}
+
+void LevelSolver::setStopCheck(const std::function<bool()>& stopCheck)
+{
+    _stopCheck = stopCheck;
+}
+
+int LevelSolver::search(GameState& state, int remaining)
+{
+    ++_nodes;
+    bool stopRequested = _stopCheck && (_nodes & (kStopCheckInterval - 1)) == 0 && _stopCheck();
+    if (stopRequested || (_maxNodes != 0 && _nodes > _maxNodes))
+    {
+        _aborted = true;
+        return kUnsolvable;
+    }
+    
+    uint64_t present = state.getPresentMask();
+    if (present == 0)
+        return kSolved;
+    
+    uint16_t key = packKey(state);
+    TTEntry& entry = _table[indexOf(present, key)];
+    if (entry.key == key && entry.present == present && entry.bound > remaining)
+        return entry.bound;
+    
+    uint64_t matchable = state.getMatchableMask();
+    int bound = lowerBound(state, matchable, _stackFaces);
+    if (bound > remaining)
+    {
+        entry.present = present;
+        entry.key = key;
+        entry.bound = static_cast<uint8_t>(bound);
+        return bound;
+    }
+    
+    GameMove moves[kMaxMoves];
+    int moveCount = generateOrderedMoves(state, matchable, moves);
+    
+    // 所有走法都失败时，本局面的下界为各走法“1 + 子局面下界”的最小值；没有走法即必然无解
+    int best = kUnsolvable;
+    for (int i = 0; i < moveCount; ++i)
+    {
+        GameMove& move = moves[i];
+        state.applyMove(move);
+        _line.push_back(move);
+        
+        int childBound = search(state, remaining - 1);
+        
+        state.unapplyMove(move);
+        if (childBound == kSolved)
+            return kSolved;
+        
+        _line.pop_back();
+        if (_aborted)
+            return kUnsolvable;
+        
+        best = std::min(best, std::min(childBound + 1, static_cast<int>(kUnsolvable)));
+    }
+    
+    // 记录已证明的下界，总是覆盖旧项
+    entry.present = present;
+    entry.key = key;
+    entry.bound = static_cast<uint8_t>(best);
+    return best;
+}
+
+void LevelSolver::buildStackFaces(const GameState& state, std::vector<uint16_t>& stackFaces)
+{
+    stackFaces.assign(state.getStackSize() + 1, 0);
+    for (int i = 0; i < state.getStackSize(); ++i)
+    {
+        stackFaces[i + 1] = stackFaces[i] | static_cast<uint16_t>(1u << state.getStackCode(i).getFaceCode());
+    }
+}
+
+int LevelSolver::lowerBound(const GameState& state, uint64_t matchable, const std::vector<uint16_t>& stackFaces)
+{
+    uint16_t playfieldFaces = 0;
+    for (int face = 1; face <= 13; ++face)
+    {
+        if (state.getFaceMask(face) != 0)
+            playfieldFaces |= static_cast<uint16_t>(1u << face);
+    }
+    
+    // 今后可能成为底牌的点数：当前底牌、手牌堆剩余卡牌、游戏区在场卡牌。
+    // 某点数的卡牌若再也等不到相邻点数的底牌，就永远无法被移走
+    uint16_t available = playfieldFaces | stackFaces[state.getStackSize()]
+        | static_cast<uint16_t>(1u << state.getTray().getFaceCode());
+    for (int face = 1; face <= 13; ++face)
+    {
+        if (((playfieldFaces >> face) & 1) && (CardCodeTables::kMatch[face] & available) == 0)
+            return kUnsolvable;
+    }
+    
+    // 两次翻牌之间连续匹配的卡牌点数逐个相差1，只能落在在场点数构成的同一段连续区间（A/K相连）内，
+    // 而卡牌只减不增，区间只会分裂不会合并，因此每段区间至少要单独翻一次牌；
+    // 当前已有可匹配卡牌时，其中一段可以不翻牌直接开始
+    uint16_t faces = static_cast<uint16_t>(playfieldFaces >> 1);
+    uint16_t previous = static_cast<uint16_t>(((faces << 1) | (faces >> 12)) & 0x1FFF);
+    int segments = faces == 0x1FFF ? 1 : countBits(faces & ~previous);
+    int draws = std::max(0, segments - (matchable != 0 ? 1 : 0));
+    if (draws > state.getStackSize())
+        return kUnsolvable;
+    
+    // 每张剩余卡牌至少需要一步匹配
+    return countBits(state.getPresentMask()) + draws;
+}
+
+int LevelSolver::generateOrderedMoves(const GameState& state, uint64_t matchable, GameMove* moves)
+{
+    // 移走后能翻开更多卡牌的匹配优先，翻牌放在最后
+    uint64_t present = state.getPresentMask();
+    int scores[GameState::kMaxPlayfieldCards];
+    int moveCount = 0;
+    for (int bit = 0; matchable != 0; ++bit, matchable >>= 1)
+    {
+        if ((matchable & 1) == 0)
+            continue;
+        
+        int score = countBits(state.getCoverMask(bit) & present);
+        int pos = moveCount++;
+        while (pos > 0 && scores[pos - 1] < score)
+        {
+            moves[pos] = moves[pos - 1];
+            scores[pos] = scores[pos - 1];
+            --pos;
+        }
+        moves[pos] = GameMove::match(bit);
+        scores[pos] = score;
+    }
+    if (state.canDraw())
+    {
+        moves[moveCount++] = GameMove::draw();
+    }
+    return moveCount;
+}
+
+uint16_t LevelSolver::packKey(const GameState& state)
+{
+    // 手牌堆顺序固定，张数即可确定其内容；匹配只与底牌点数有关。最高位置1以区分空项
+    return static_cast<uint16_t>(0x8000 | (state.getStackSize() << 4) | state.getTray().getFaceCode());
+}
+
+size_t LevelSolver::indexOf(uint64_t present, uint16_t key) const
+{
+    return static_cast<size_t>(Zobrist::mix(present ^ (static_cast<uint64_t>(key) << 48))) & _tableMask;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file LevelSolver.h
+ * @brief 无界面关卡求解器头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 在位棋盘GameState上做迭代加深深度优先搜索，判断关卡能否通关并给出最短通关走法
+ * 不依赖cocos2d，可同时被游戏（提示、关卡校验）和命令行工具使用
+ */
+
+#ifndef __LEVEL_SOLVER_H__
+#define __LEVEL_SOLVER_H__
+
+#include "../models/GameState.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * 求解器使用的关卡描述
+ * 与LevelConfig含义相同，但只用基础类型，命令行工具无需链接cocos2d即可构造
+ */
+struct SolverLevel
+{
+    struct Card
+    {
+        CardCode code;      // 卡牌编码
+        float x;            // 中心位置X
+        float y;            // 中心位置Y
+    };
+    
+    std::vector<Card> playfield;        // 游戏区卡牌，按放置顺序（后放置的在上层）
+    std::vector<CardCode> stack;        // 手牌堆卡牌，按配置顺序（与关卡生成一致，最后一张作为初始底牌）
+    float cardWidth;                    // 卡牌宽度，与CardResConfig::kCardSize一致
+    float cardHeight;                   // 卡牌高度
+    
+    SolverLevel() : cardWidth(160.0f), cardHeight(220.0f) {}
+};
+
+/**
+ * 求解结果
+ */
+struct SolverResult
+{
+    bool solvable;                  // 是否可以通关
+    bool complete;                  // 搜索是否完整结束（未因节点上限中止）
+    std::vector<GameMove> line;     // 最短通关走法（可通关时有效）
+    uint64_t nodes;                 // 搜索的节点数
+    
+    SolverResult() : solvable(false), complete(false), nodes(0) {}
+};
+
+/**
+ * @class LevelSolver
+ * @brief 精确关卡求解器
+ *
+ * 搜索方式：
+ * - 迭代加深：初始深度为游戏区剩余卡牌数（每张至少一步匹配），每轮失败时
+ *   返回已证明的步数下界并直接加深到该值，因此第一次找到的解即为步数最少的解；
+ *   下界达到kUnsolvable即不可通关
+ * - 置换表：以(游戏区在场掩码, 手牌堆张数, 底牌点数)为完整局面键，
+ *   记录该局面已证明的通关步数下界，剩余步数不足下界时直接剪枝，跨轮次复用
+ * - 下界：剩余卡牌数 + 必需翻牌次数（在场点数分成的连续区间数），
+ *   并剪掉相邻点数再也不可能成为底牌的局面
+ * - 走法排序：先匹配后翻牌，匹配时优先移走压住更多卡牌的卡牌
+ */
+class LevelSolver
+{
+public:
+    /**
+     * @param ttBits 置换表大小为 2^ttBits 项
+     */
+    explicit LevelSolver(int ttBits = 20);
+    
+    /**
+     * @brief 按关卡生成规则构造初始局面（覆盖关系、初始底牌与GameModelFromLevelGenerator一致）
+     * @return 卡牌数量超出位棋盘容量时返回false
+     */
+    static bool buildState(const SolverLevel& level, GameState& state);
+    
+    /**
+     * @brief 求解
+     * @param initial 初始局面
+     * @param maxNodes 节点上限，0表示不限制
+     */
+    SolverResult solve(const GameState& initial, uint64_t maxNodes = 0);
+    
+    /**
+     * @brief 设置中止检查
+     * @param stopCheck 搜索中每隔kStopCheckInterval个节点调用一次，返回true时中止搜索（结果complete为false）；
+     *                  传入空函数取消检查。用于时间预算和外部取消
+     */
+    void setStopCheck(const std::function<bool()>& stopCheck);
+    
+    static const uint64_t kStopCheckInterval = 1024;   // 中止检查间隔（节点数，2的幂）
+    
+    // ==================== 搜索工具（串行与并行求解器共用） ====================
+    
+    static const int kUnsolvable = 0xFF;                                // 步数下界：无论多少步都无法通关
+    static const int kMaxMoves = GameState::kMaxPlayfieldCards + 1;     // 单个局面的最大走法数
+    
+    /**
+     * @brief 预先计算手牌堆前n张包含的点数编码集合（下标为手牌堆张数）
+     */
+    static void buildStackFaces(const GameState& state, std::vector<uint16_t>& stackFaces);
+    
+    /**
+     * @brief 通关所需步数的下界（可采纳启发）
+     * 剩余卡牌数加上必需的翻牌次数；存在永远无法被移走的卡牌时返回kUnsolvable
+     */
+    static int lowerBound(const GameState& state, uint64_t matchable, const std::vector<uint16_t>& stackFaces);
+    
+    /**
+     * @brief 按搜索顺序生成走法：先匹配后翻牌，匹配时优先移走压住更多卡牌的卡牌
+     * @param moves 输出数组，至少kMaxMoves项
+     * @return 走法数量
+     */
+    static int generateOrderedMoves(const GameState& state, uint64_t matchable, GameMove* moves);
+    
+    /**
+     * @brief 局面键：手牌堆张数与底牌点数（与游戏区在场掩码一起完整描述局面，0保留给空项）
+     */
+    static uint16_t packKey(const GameState& state);
+
+private:
+    static const int kSolved = -1;              // 搜索返回值：找到通关走法
+    
+    /**
+     * 置换表项
+     */
+    struct TTEntry
+    {
+        uint64_t present;       // 游戏区在场掩码
+        uint16_t key;           // 手牌堆张数与底牌点数（0表示空项）
+        uint8_t bound;          // 已证明的通关步数下界（kUnsolvable表示无解）
+    };
+    
+    /**
+     * @brief 在剩余步数内搜索通关走法
+     * @return 找到通关走法返回kSolved，走法保存在_line中；
+     *         否则返回已证明的通关步数下界（大于remaining）
+     */
+    int search(GameState& state, int remaining);
+    
+    // 计算置换表下标
+    size_t indexOf(uint64_t present, uint16_t key) const;
+    
+    std::vector<TTEntry> _table;    // 置换表
+    size_t _tableMask;              // 置换表下标掩码
+    std::vector<GameMove> _line;    // 当前搜索路径
+    std::vector<uint16_t> _stackFaces;  // 手牌堆前n张的点数编码集合
+    uint64_t _nodes;                // 已搜索节点数
+    uint64_t _maxNodes;             // 节点上限
+    bool _aborted;                  // 是否因节点上限或中止检查而中止
+    std::function<bool()> _stopCheck;   // 中止检查
+};
+
+#endif // __LEVEL_SOLVER_H__
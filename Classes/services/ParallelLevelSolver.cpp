@@ -0,0 +1,307 @@
+#include "ParallelLevelSolver.h"
+#include "../utils/Zobrist.h"
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    // 线程私有节点计数每累计这么多次汇总一次，减少原子操作
+    const uint64_t kNodeFlushInterval = 1024;
+}
+
+ParallelLevelSolver::ParallelLevelSolver(int threadCount, int ttBits)
+    : _threadCount(threadCount)
+    , _tableMask(0)
+    , _pendingTasks(0)
+    , _idleWorkers(0)
+    , _stop(false)
+    , _nodes(0)
+    , _maxNodes(0)
+    , _aborted(false)
+    , _solved(false)
+{
+    if (_threadCount <= 0)
+        _threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    
+    ttBits = std::min(std::max(ttBits, 10), 28);
+    size_t tableSize = static_cast<size_t>(1) << ttBits;
+    _table.reset(new TTSlot[tableSize]);
+    _tableMask = tableSize - 1;
+    
+    for (int i = 0; i < _threadCount; ++i)
+    {
+        _workers.emplace_back(new Worker());
+    }
+}
+
+ParallelLevelSolver::~ParallelLevelSolver()
+{
+}
+
+SolverResult ParallelLevelSolver::solve(const GameState& initial, uint64_t maxNodes)
+{
+    SolverResult result;
+    if (!initial.isValid())
+        return result;
+    
+    for (size_t i = 0; i <= _tableMask; ++i)
+    {
+        _table[i].check.store(0, std::memory_order_relaxed);
+        _table[i].data.store(0, std::memory_order_relaxed);
+    }
+    for (auto& worker : _workers)
+    {
+        worker->tasks.clear();
+        worker->line.clear();
+        worker->nodes = 0;
+    }
+    
+    _pendingTasks.store(0);
+    _idleWorkers.store(0);
+    _stop.store(false);
+    _nodes.store(1);
+    _maxNodes = maxNodes;
+    _aborted = false;
+    _solved = false;
+    _solution.clear();
+    LevelSolver::buildStackFaces(initial, _stackFaces);
+    
+    result.nodes = 1;
+    if (initial.isCleared())
+    {
+        result.solvable = true;
+        result.complete = true;
+        return result;
+    }
+    
+    // 按根局面的合法走法拆分任务，轮流分给各线程
+    uint64_t matchable = initial.getMatchableMask();
+    GameMove moves[LevelSolver::kMaxMoves];
+    int moveCount = 0;
+    if (LevelSolver::lowerBound(initial, matchable, _stackFaces) < LevelSolver::kUnsolvable)
+    {
+        moveCount = LevelSolver::generateOrderedMoves(initial, matchable, moves);
+    }
+    
+    for (int i = 0; i < moveCount; ++i)
+    {
+        Task task;
+        task.state = initial;
+        task.state.applyMove(moves[i]);
+        task.line.push_back(moves[i]);
+        pushTask(i % _threadCount, std::move(task));
+    }
+    
+    // 调用线程作为0号线程参与搜索
+    std::vector<std::thread> threads;
+    for (int i = 1; i < _threadCount; ++i)
+    {
+        threads.emplace_back(&ParallelLevelSolver::runWorker, this, i);
+    }
+    runWorker(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    
+    result.solvable = _solved;
+    result.complete = _solved || !_aborted;
+    result.line = _solution;
+    result.nodes = _nodes.load();
+    return result;
+}
+
+void ParallelLevelSolver::runWorker(int index)
+{
+    Worker& worker = *_workers[index];
+    Task task;
+    bool idle = false;
+    
+    while (!_stop.load(std::memory_order_relaxed))
+    {
+        if (takeTask(index, task))
+        {
+            if (idle)
+            {
+                _idleWorkers.fetch_sub(1);
+                idle = false;
+            }
+            
+            worker.line = std::move(task.line);
+            if (search(worker, index, task.state))
+            {
+                std::lock_guard<std::mutex> lock(_resultMutex);
+                if (!_solved)
+                {
+                    _solved = true;
+                    _solution = worker.line;
+                }
+                _stop.store(true);
+            }
+            _pendingTasks.fetch_sub(1);
+        }
+        else
+        {
+            // 所有任务（包括正在执行、可能继续拆分的任务）都已完成才退出
+            if (_pendingTasks.load() == 0)
+                break;
+            
+            if (!idle)
+            {
+                _idleWorkers.fetch_add(1);
+                idle = true;
+            }
+            std::this_thread::yield();
+        }
+    }
+    
+    if (idle)
+    {
+        _idleWorkers.fetch_sub(1);
+    }
+    flushNodes(worker);
+}
+
+bool ParallelLevelSolver::takeTask(int index, Task& task)
+{
+    {
+        Worker& own = *_workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    
+    for (int offset = 1; offset < _threadCount; ++offset)
+    {
+        Worker& victim = *_workers[(index + offset) % _threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void ParallelLevelSolver::pushTask(int index, Task&& task)
+{
+    _pendingTasks.fetch_add(1);
+    
+    Worker& worker = *_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+}
+
+bool ParallelLevelSolver::search(Worker& worker, int index, GameState& state)
+{
+    if (++worker.nodes >= kNodeFlushInterval)
+    {
+        flushNodes(worker);
+    }
+    if (_stop.load(std::memory_order_relaxed))
+        return false;
+    
+    uint64_t present = state.getPresentMask();
+    if (present == 0)
+        return true;
+    
+    uint16_t key = LevelSolver::packKey(state);
+    if (probeDead(present, key))
+        return false;
+    
+    uint64_t matchable = state.getMatchableMask();
+    if (LevelSolver::lowerBound(state, matchable, _stackFaces) >= LevelSolver::kUnsolvable)
+    {
+        storeDead(present, key);
+        return false;
+    }
+    
+    GameMove moves[LevelSolver::kMaxMoves];
+    int moveCount = LevelSolver::generateOrderedMoves(state, matchable, moves);
+    
+    // 有线程空闲且自己没有待处理任务时，把除第一步以外的走法拆成任务
+    bool split = false;
+    if (moveCount > 1 && _idleWorkers.load(std::memory_order_relaxed) > 0)
+    {
+        bool ownQueueEmpty;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            ownQueueEmpty = worker.tasks.empty();
+        }
+        
+        if (ownQueueEmpty)
+        {
+            for (int i = moveCount - 1; i >= 1; --i)
+            {
+                Task task;
+                task.state = state;
+                task.state.applyMove(moves[i]);
+                task.line = worker.line;
+                task.line.push_back(moves[i]);
+                pushTask(index, std::move(task));
+            }
+            moveCount = 1;
+            split = true;
+        }
+    }
+    
+    for (int i = 0; i < moveCount; ++i)
+    {
+        GameMove& move = moves[i];
+        state.applyMove(move);
+        worker.line.push_back(move);
+        
+        bool solved = search(worker, index, state);
+        
+        state.unapplyMove(move);
+        if (solved)
+            return true;
+        
+        worker.line.pop_back();
+        if (_stop.load(std::memory_order_relaxed))
+            return false;
+    }
+    
+    // 拆分出去的走法结果未知，只有完整搜索过的局面才能记为无解
+    if (!split)
+    {
+        storeDead(present, key);
+    }
+    return false;
+}
+
+void ParallelLevelSolver::flushNodes(Worker& worker)
+{
+    uint64_t total = _nodes.fetch_add(worker.nodes) + worker.nodes;
+    worker.nodes = 0;
+    
+    if (_maxNodes != 0 && total > _maxNodes)
+    {
+        std::lock_guard<std::mutex> lock(_resultMutex);
+        _aborted = true;
+        _stop.store(true);
+    }
+}
+
+bool ParallelLevelSolver::probeDead(uint64_t present, uint16_t key) const
+{
+    const TTSlot& slot = _table[Zobrist::mix(present ^ (static_cast<uint64_t>(key) << 48)) & _tableMask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    return data == key && (check ^ data) == present;
+}
+
+void ParallelLevelSolver::storeDead(uint64_t present, uint16_t key)
+{
+    // 两个字分别写入，读取方用异或校验丢弃被并发写入撕裂的项
+    TTSlot& slot = _table[Zobrist::mix(present ^ (static_cast<uint64_t>(key) << 48)) & _tableMask];
+    slot.check.store(present ^ key, std::memory_order_relaxed);
+    slot.data.store(key, std::memory_order_relaxed);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file ParallelLevelSolver.h
+ * @brief 多线程关卡可解性求解器头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 离线关卡流水线使用的并行版本：只回答“能否通关”并给出任意一条通关走法（不保证最短）
+ * 不依赖cocos2d
+ */
+
+#ifndef __PARALLEL_LEVEL_SOLVER_H__
+#define __PARALLEL_LEVEL_SOLVER_H__
+
+#include "LevelSolver.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class ParallelLevelSolver
+ * @brief 工作窃取的并行可解性求解器
+ *
+ * - 任务划分：根局面按当前底牌下的合法走法拆成任务；搜索中有空闲线程且自己的任务队列已空时，
+ *   当前局面的其余走法也拆成任务压入队列，供其他线程窃取
+ * - 负载均衡：每个线程一个双端队列，自己从尾部取（深度优先、局部性好），
+ *   空闲线程从其他线程的头部窃取（靠近根部、子树更大）
+ * - 共享置换表：无锁，只记录“必然无解”的局面；每项为两个原子64位字，
+ *   以异或校验识别并发写入造成的撕裂项
+ * - 剪枝与走法排序与LevelSolver相同
+ */
+class ParallelLevelSolver
+{
+public:
+    /**
+     * @param threadCount 线程数，0表示使用硬件并发数
+     * @param ttBits 置换表大小为 2^ttBits 项
+     */
+    explicit ParallelLevelSolver(int threadCount = 0, int ttBits = 22);
+    ~ParallelLevelSolver();
+    
+    /**
+     * @brief 求解
+     * @param initial 初始局面
+     * @param maxNodes 所有线程合计的节点上限，0表示不限制
+     */
+    SolverResult solve(const GameState& initial, uint64_t maxNodes = 0);
+    
+    int getThreadCount() const { return _threadCount; }
+
+private:
+    /**
+     * 搜索任务：从某个局面开始的子树，以及从根局面到达它的走法
+     */
+    struct Task
+    {
+        GameState state;
+        std::vector<GameMove> line;
+    };
+    
+    /**
+     * 线程私有数据
+     */
+    struct Worker
+    {
+        std::mutex mutex;               // 保护任务队列
+        std::deque<Task> tasks;         // 任务队列：自己从尾部取，其他线程从头部窃取
+        std::vector<GameMove> line;     // 当前搜索路径（含任务前缀）
+        uint64_t nodes;                 // 尚未汇总到全局计数的节点数
+        
+        Worker() : nodes(0) {}
+    };
+    
+    /**
+     * 置换表项：data = 局面键（非0），check = 在场掩码 ^ data
+     */
+    struct TTSlot
+    {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    
+    // 线程主循环
+    void runWorker(int index);
+    
+    // 取任务：先取自己队列尾部，再依次窃取其他线程队列头部
+    bool takeTask(int index, Task& task);
+    
+    // 压入任务
+    void pushTask(int index, Task&& task);
+    
+    /**
+     * @brief 深度优先搜索
+     * @return 找到通关走法返回true
+     */
+    bool search(Worker& worker, int index, GameState& state);
+    
+    // 汇总节点计数，超出上限时请求停止
+    void flushNodes(Worker& worker);
+    
+    // 置换表
+    bool probeDead(uint64_t present, uint16_t key) const;
+    void storeDead(uint64_t present, uint16_t key);
+    
+    int _threadCount;                                   // 线程数
+    std::unique_ptr<TTSlot[]> _table;                   // 共享置换表
+    size_t _tableMask;                                  // 置换表下标掩码
+    std::vector<std::unique_ptr<Worker>> _workers;      // 线程私有数据
+    std::vector<uint16_t> _stackFaces;                  // 手牌堆前n张的点数编码集合
+    
+    std::atomic<int> _pendingTasks;                     // 已创建但尚未完成的任务数
+    std::atomic<int> _idleWorkers;                      // 正在等待任务的线程数
+    std::atomic<bool> _stop;                            // 找到解或超出节点上限
+    std::atomic<uint64_t> _nodes;                       // 全局节点计数
+    uint64_t _maxNodes;                                 // 节点上限
+    bool _aborted;                                      // 是否因节点上限中止（受_resultMutex保护）
+    
+    std::mutex _resultMutex;                            // 保护求解结果
+    bool _solved;                                       // 是否已找到通关走法
+    std::vector<GameMove> _solution;                    // 通关走法
+};
+
+#endif // __PARALLEL_LEVEL_SOLVER_H__
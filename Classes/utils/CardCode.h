@@ -0,0 +1,132 @@
+/**
+ * @file CardCode.h
+ * @brief 卡牌紧凑编码头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 将卡牌的点数和花色打包进一个字节
+ * 点数数值、花色颜色、匹配关系均由编译期常量表查询得到
+ * 匹配判断只需一次查表，不再需要分支和循环特判
+ */
+
+#ifndef __CARD_CODE_H__
+#define __CARD_CODE_H__
+
+#include "CardTypes.h"
+#include <cstdint>
+
+namespace CardCodeTables
+{
+    /**
+     * 点数编码（低4位）-> 点数数值
+     * 编码0为无效点数，与原getFaceValue保持一致返回1
+     */
+    static constexpr uint8_t kFaceValue[16] = {
+        1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 1, 1
+    };
+    
+    /**
+     * 花色编码（高4位）-> 是否为红色
+     * 依次为：无效、草花、方块、红心、黑桃
+     */
+    static constexpr bool kRedSuit[16] = {
+        false, false, true, true, false, false, false, false,
+        false, false, false, false, false, false, false, false
+    };
+    
+    /**
+     * 计算某个点数编码可匹配的点数集合
+     * @param code 点数编码（1=A ... 13=K）
+     * @return 可匹配点数编码的位掩码，点数差1或A/K循环
+     */
+    constexpr uint16_t matchRow(int code)
+    {
+        return (code < 1 || code > 13) ? 0
+            : static_cast<uint16_t>((1u << (code % 13 + 1)) | (1u << ((code + 11) % 13 + 1)));
+    }
+    
+    /**
+     * 13x13匹配位表（按点数编码索引，补齐到16行以便直接用低4位查表）
+     * kMatch[a] 的第b位为1表示点数编码a与b可以匹配
+     */
+    static constexpr uint16_t kMatch[16] = {
+        matchRow(0), matchRow(1), matchRow(2), matchRow(3),
+        matchRow(4), matchRow(5), matchRow(6), matchRow(7),
+        matchRow(8), matchRow(9), matchRow(10), matchRow(11),
+        matchRow(12), matchRow(13), matchRow(14), matchRow(15)
+    };
+}
+
+/**
+ * @struct CardCode
+ * @brief 单字节卡牌编码
+ *
+ * 编码格式：
+ * - 低4位：点数+1（0表示无效，1=A ... 13=K，恰好等于点数数值）
+ * - 高4位：花色+1（0表示无效，1=草花 ... 4=黑桃）
+ */
+struct CardCode
+{
+    uint8_t bits;   /**< 打包后的编码 */
+    
+    constexpr CardCode() : bits(0) {}
+    
+    constexpr CardCode(CardFaceType face, CardSuitType suit)
+        : bits(static_cast<uint8_t>(((suit + 1) << 4) | (face + 1)))
+    {
+    }
+    
+    /**
+     * @brief 从原始字节构造
+     * @param raw 已编码的字节
+     */
+    static constexpr CardCode fromBits(uint8_t raw) { return CardCode(raw, 0); }
+    
+    constexpr CardFaceType getFace() const { return static_cast<CardFaceType>((bits & 0x0F) - 1); }
+    constexpr CardSuitType getSuit() const { return static_cast<CardSuitType>((bits >> 4) - 1); }
+    
+    /**
+     * @brief 点数编码（1=A ... 13=K，0为无效），可直接用作匹配表下标
+     */
+    constexpr int getFaceCode() const { return bits & 0x0F; }
+    
+    /**
+     * @brief 点数数值（A=1 ... K=13）
+     */
+    constexpr int getFaceValue() const { return CardCodeTables::kFaceValue[bits & 0x0F]; }
+    
+    /**
+     * @brief 是否为红色花色（红心/方块）
+     */
+    constexpr bool isRed() const { return CardCodeTables::kRedSuit[bits >> 4]; }
+    
+    /**
+     * @brief 两张卡牌是否可以匹配（点数差1，A/K循环，不限花色）
+     */
+    constexpr bool canMatch(CardCode other) const
+    {
+        return ((CardCodeTables::kMatch[bits & 0x0F] >> (other.bits & 0x0F)) & 1) != 0;
+    }
+    
+    /**
+     * @brief 判断花色是否为红色
+     */
+    static constexpr bool isRedSuit(CardSuitType suit)
+    {
+        return (suit >= CST_CLUBS && suit < CST_NUM_CARD_SUIT_TYPES) && CardCodeTables::kRedSuit[suit + 1];
+    }
+    
+    constexpr bool operator==(CardCode other) const { return bits == other.bits; }
+    constexpr bool operator!=(CardCode other) const { return bits != other.bits; }
+
+private:
+    constexpr CardCode(uint8_t raw, int) : bits(raw) {}
+};
+
+static_assert(sizeof(CardCode) == 1, "CardCode must stay one byte");
+static_assert(CardCode(CFT_ACE, CST_SPADES).canMatch(CardCode(CFT_KING, CST_HEARTS)), "A/K wraparound");
+static_assert(CardCode(CFT_FIVE, CST_CLUBS).canMatch(CardCode(CFT_SIX, CST_CLUBS)), "adjacent faces match");
+static_assert(!CardCode(CFT_FIVE, CST_CLUBS).canMatch(CardCode(CFT_FIVE, CST_HEARTS)), "equal faces do not match");
+static_assert(CardCode(CFT_QUEEN, CST_DIAMONDS).getFaceValue() == 12, "face value table");
+
+#endif // __CARD_CODE_H__
@@ -0,0 +1,72 @@
+/**
+ * @file CardCoverage.h
+ * @brief 卡牌覆盖关系计算头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 根据游戏区卡牌的放置顺序和位置计算覆盖关系：
+ * 后放置的卡牌绘制在上层，与先放置的卡牌矩形重叠时压住它
+ * 不依赖cocos2d，关卡生成和无界面求解器共用同一套规则
+ */
+
+#ifndef __CARD_COVERAGE_H__
+#define __CARD_COVERAGE_H__
+
+#include <cmath>
+#include <vector>
+
+namespace CardCoverage
+{
+    /**
+     * 覆盖关系图（压缩邻接表）
+     * 第i张卡牌压住 coveredIds[offsets[i] .. offsets[i+1]) 中的卡牌
+     */
+    struct Graph
+    {
+        std::vector<int> offsets;
+        std::vector<int> coveredIds;
+    };
+    
+    /**
+     * @brief 判断上层卡牌是否压住下层卡牌（两张卡牌中心对齐的矩形是否重叠）
+     */
+    inline bool covers(float topX, float topY, float bottomX, float bottomY, float width, float height)
+    {
+        return std::fabs(topX - bottomX) < width && std::fabs(topY - bottomY) < height;
+    }
+    
+    /**
+     * @brief 计算覆盖关系图
+     * @param count 卡牌数量，下标即放置顺序
+     * @param width 卡牌宽度
+     * @param height 卡牌高度
+     * @param positionAt 按下标返回卡牌中心位置（需有x、y成员）
+     */
+    template <typename PositionAt>
+    Graph build(int count, float width, float height, PositionAt positionAt)
+    {
+        Graph graph;
+        graph.offsets.assign(count + 1, 0);
+        
+        // 只有下标更大的卡牌能压住下标更小的卡牌，因此结果必然是有向无环图
+        for (int blocker = 0; blocker < count; ++blocker)
+        {
+            graph.offsets[blocker] = static_cast<int>(graph.coveredIds.size());
+            auto top = positionAt(blocker);
+            
+            for (int covered = 0; covered < blocker; ++covered)
+            {
+                auto bottom = positionAt(covered);
+                if (covers(top.x, top.y, bottom.x, bottom.y, width, height))
+                {
+                    graph.coveredIds.push_back(covered);
+                }
+            }
+        }
+        graph.offsets[count] = static_cast<int>(graph.coveredIds.size());
+        
+        return graph;
+    }
+}
+
+#endif // __CARD_COVERAGE_H__
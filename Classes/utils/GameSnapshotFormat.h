@@ -0,0 +1,121 @@
+/**
+ * @file GameSnapshotFormat.h
+ * @brief 游戏存档二进制格式定义
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 存档是一块扁平的连续内存：文件头 + 若干定长记录数组（段），段按8字节对齐，
+ * 全部为平凡可复制类型，按本机字节序存放，可以直接在mmap或读入的缓冲区上原地访问
+ * 不依赖cocos2d
+ */
+
+#ifndef __GAME_SNAPSHOT_FORMAT_H__
+#define __GAME_SNAPSHOT_FORMAT_H__
+
+#include <cstdint>
+#include <type_traits>
+
+namespace GameSnapshotFormat
+{
+    static const uint32_t kMagic = 0x53534750;      // "PGSS"
+    static const uint16_t kVersion = 1;
+    static const uint32_t kAlignment = 8;           // 段起始偏移的对齐
+    
+    /**
+     * 段编号
+     */
+    enum SectionId
+    {
+        GSS_CARDS,                  // CardRecord，下标即cardId
+        GSS_PLAYFIELD,              // int32_t，游戏区卡牌（保持模型中的顺序）
+        GSS_STACK_ORDER,            // int32_t，手牌堆初始顺序，当前手牌堆是它的前缀
+        GSS_COVER_OFFSETS,          // int32_t，覆盖关系邻接表偏移
+        GSS_COVERED_IDS,            // int32_t，覆盖关系邻接表
+        GSS_UNDO_NODES,             // 撤销历史节点池，记录原样保存（记录长度见Section::stride）
+        GSS_UNDO_SNAPSHOTS,         // uint64_t，撤销历史的状态快照池
+        GSS_UNDO_FREE_SNAPSHOTS,    // int32_t，快照池空闲下标
+        GSS_SECTION_COUNT
+    };
+    
+    /**
+     * 段描述：起始偏移（相对文件头）、记录数、每条记录的字节数
+     */
+    struct Section
+    {
+        uint32_t offset;
+        uint32_t count;
+        uint32_t stride;
+    };
+    
+    /**
+     * 卡牌记录
+     */
+    struct CardRecord
+    {
+        float x, y;                 // 当前位置
+        float originalX, originalY; // 初始位置
+        uint8_t code;               // CardCode::bits
+        uint8_t visible;
+        uint16_t reserved;
+    };
+    
+    /**
+     * 游戏模型中的标量
+     */
+    struct ModelHeader
+    {
+        int32_t trayCardId;
+        float trayX, trayY;
+        int32_t score;
+        uint32_t stackSize;         // 当前手牌堆高度
+        uint8_t gameActive;
+        uint8_t reserved[3];
+        uint64_t zobristHash;       // 加载后重算比对，防止存档与规则不一致
+    };
+    
+    /**
+     * 撤销历史中的标量，hasUndo为0时没有撤销历史段
+     */
+    struct UndoHeader
+    {
+        int32_t freeHead;
+        int32_t root;
+        int32_t current;
+        uint32_t nodeCount;
+        uint32_t nextSerial;
+        uint32_t maxUndoSteps;
+        int32_t snapshotInterval;
+        uint32_t snapshotStride;
+        uint32_t snapshotCount;
+        uint8_t hasBranches;
+        uint8_t hasUndo;
+        uint8_t reserved[2];
+    };
+    
+    /**
+     * 文件头
+     */
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;        // sizeof(FileHeader)，读取时校验
+        uint32_t totalSize;         // 整个存档的字节数
+        uint32_t reserved;
+        ModelHeader model;
+        UndoHeader undo;
+        Section sections[GSS_SECTION_COUNT];
+    };
+    
+    static_assert(std::is_trivially_copyable<FileHeader>::value, "snapshot header must stay trivially copyable");
+    static_assert(sizeof(CardRecord) == 20, "CardRecord layout is part of the file format");
+    static_assert(sizeof(FileHeader) % kAlignment == 0, "sections after the header must stay aligned");
+    
+    // 向上取整到段对齐
+    inline uint32_t align(uint32_t offset)
+    {
+        return (offset + kAlignment - 1) & ~(kAlignment - 1);
+    }
+}
+
+#endif // __GAME_SNAPSHOT_FORMAT_H__
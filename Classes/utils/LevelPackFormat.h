@@ -0,0 +1,66 @@
+/**
+ * @file LevelPackFormat.h
+ * @brief 关卡包二进制格式定义
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 关卡包把一批关卡JSON离线编译为一个文件：文件头 + 按关卡ID排列的偏移索引 + 定长卡牌记录，
+ * 全部为平凡可复制类型，按本机字节序存放，运行时mmap后原地访问，不需要解析
+ * 不依赖cocos2d
+ */
+
+#ifndef __LEVEL_PACK_FORMAT_H__
+#define __LEVEL_PACK_FORMAT_H__
+
+#include <cstdint>
+#include <type_traits>
+
+namespace LevelPackFormat
+{
+    static const uint32_t kMagic = 0x50564C50;      // "PLVP"
+    static const uint16_t kVersion = 1;
+    
+    /**
+     * 文件头，紧接着是levelCount个LevelEntry
+     * 关卡ID连续编号：关卡firstLevelId + i 的索引项为第i项
+     */
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;        // sizeof(FileHeader)，读取时校验
+        uint32_t totalSize;         // 整个关卡包的字节数
+        int32_t firstLevelId;
+        uint32_t levelCount;
+        uint16_t entrySize;         // sizeof(LevelEntry)
+        uint16_t cardSize;          // sizeof(CardRecord)
+    };
+    
+    /**
+     * 关卡索引项：卡牌记录的起始偏移（相对文件头），先游戏区后手牌堆
+     * offset为0表示编号范围内缺少该关卡
+     */
+    struct LevelEntry
+    {
+        uint32_t offset;
+        uint16_t playfieldCount;
+        uint16_t stackCount;
+    };
+    
+    /**
+     * 卡牌记录
+     */
+    struct CardRecord
+    {
+        float x, y;                 // 位置（手牌堆卡牌为0）
+        uint8_t code;               // CardCode::bits
+        uint8_t reserved[3];
+    };
+    
+    static_assert(std::is_trivially_copyable<FileHeader>::value, "level pack header must stay trivially copyable");
+    static_assert(sizeof(FileHeader) == 24, "FileHeader layout is part of the file format");
+    static_assert(sizeof(LevelEntry) == 8, "LevelEntry layout is part of the file format");
+    static_assert(sizeof(CardRecord) == 12, "CardRecord layout is part of the file format");
+}
+
+#endif // __LEVEL_PACK_FORMAT_H__
@@ -0,0 +1,95 @@
+/**
+ * @file PersistentArray.h
+ * @brief 分块写时复制数组头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 定长数组按kChunkSize个元素分块存放，块和块表都由shared_ptr共享：
+ * 复制数组只增加一次块表的引用计数，O(1)；修改元素时只复制被共享的块表和所在的块
+ * 不依赖cocos2d
+ */
+
+#ifndef __PERSISTENT_ARRAY_H__
+#define __PERSISTENT_ARRAY_H__
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class PersistentArray
+ * @brief 分块写时复制数组
+ *
+ * 线程安全：同一个实例不能在多个线程上同时使用；复制出的实例之间互不影响，可以分别交给不同线程
+ * （引用计数为1时说明没有其他实例共享，原地修改是安全的）
+ */
+template <typename T, int ChunkBits = 5>
+class PersistentArray
+{
+    static_assert(std::is_trivially_copyable<T>::value, "PersistentArray stores plain records");
+
+public:
+    static const size_t kChunkSize = static_cast<size_t>(1) << ChunkBits;
+    
+    PersistentArray() : _size(0) {}
+    
+    /**
+     * @param size 元素个数（之后不再改变）
+     * @param value 初始值
+     */
+    explicit PersistentArray(size_t size, const T& value = T())
+        : _table(std::make_shared<Table>((size + kChunkSize - 1) / kChunkSize))
+        , _size(size)
+    {
+        for (auto& chunk : *_table)
+        {
+            chunk = std::make_shared<Chunk>();
+            for (T& element : chunk->values)
+            {
+                element = value;
+            }
+        }
+    }
+    
+    size_t size() const { return _size; }
+    
+    const T& operator[](size_t index) const
+    {
+        return (*_table)[index >> ChunkBits]->values[index & (kChunkSize - 1)];
+    }
+    
+    /**
+     * 取得可写引用：块表或块被其他实例共享时先复制
+     * 引用在下一次修改其他块之前有效
+     */
+    T& mutate(size_t index)
+    {
+        if (_table.use_count() > 1)
+        {
+            _table = std::make_shared<Table>(*_table);
+        }
+        
+        std::shared_ptr<Chunk>& chunk = (*_table)[index >> ChunkBits];
+        if (chunk.use_count() > 1)
+        {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+        return chunk->values[index & (kChunkSize - 1)];
+    }
+    
+    void set(size_t index, const T& value) { mutate(index) = value; }
+
+private:
+    struct Chunk
+    {
+        T values[kChunkSize];
+    };
+    
+    typedef std::vector<std::shared_ptr<Chunk>> Table;
+    
+    std::shared_ptr<Table> _table;      // 块表
+    size_t _size;                       // 元素个数
+};
+
+#endif // __PERSISTENT_ARRAY_H__
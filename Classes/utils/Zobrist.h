@@ -0,0 +1,42 @@
+/**
+ * @file Zobrist.h
+ * @brief Zobrist哈希键头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 为每个(卡牌ID, 区域)组合提供固定的64位随机键
+ * 局面哈希为所有卡牌当前所在区域键的异或，卡牌换区时只需异或两次即可增量更新
+ * 不依赖cocos2d，可被求解器、置换表、回放去重等模块直接使用
+ */
+
+#ifndef __ZOBRIST_H__
+#define __ZOBRIST_H__
+
+#include <cstdint>
+
+namespace Zobrist
+{
+    /**
+     * splitmix64混合函数，相邻的输入也能得到分布均匀的输出
+     */
+    constexpr uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+    
+    /**
+     * 卡牌位于某区域时的哈希键
+     * 区域0（不在任何区域）的键固定为0，因此已移除/未放置的卡牌不影响哈希
+     * @param cardId 卡牌ID
+     * @param zone 区域编号（与CardZone取值一致）
+     */
+    constexpr uint64_t key(int cardId, int zone)
+    {
+        return zone == 0 ? 0 : mix((static_cast<uint64_t>(cardId) << 2) | static_cast<uint64_t>(zone & 3));
+    }
+}
+
+#endif // __ZOBRIST_H__
@@ -0,0 +1,206 @@
+#include "CardFaceCompositor.h"
+#include "../configs/models/CardResConfig.h"
+#include <algorithm>
+
+USING_NS_CC;
+
+namespace
+{
+    const int kColumns = 8;                 // 每行格子数，8x7格放得下52个牌面，纹理边长不超过2048
+    const int kRows = (CardFaceCompositor::kMaxFaces + kColumns - 1) / kColumns;
+    const float kSpacing = 2.0f;            // 格子之间的透明间隔，缩放采样时不会串入相邻牌面
+    
+    CardFaceCompositor* s_sharedCompositor = nullptr;
+    
+    Size cellSize()
+    {
+        Size cardSize = CardResConfig::getCardSize();
+        return Size(cardSize.width + kSpacing, cardSize.height + kSpacing);
+    }
+    
+    // 格子在纹理中的区域（精灵帧坐标，左上角为原点）
+    Rect cellRect(int slot)
+    {
+        Size cell = cellSize();
+        return Rect(Vec2((slot % kColumns) * cell.width, (slot / kColumns) * cell.height), CardResConfig::getCardSize());
+    }
+    
+    Sprite* createPart(SpriteFrame* frame, const Vec2& position, float scale)
+    {
+        Sprite* sprite = frame ? Sprite::createWithSpriteFrame(frame) : nullptr;
+        if (sprite)
+        {
+            sprite->setPosition(position);
+            sprite->setScale(scale);
+        }
+        return sprite;
+    }
+}
+
+CardFaceCompositor* CardFaceCompositor::getInstance()
+{
+    if (!s_sharedCompositor)
+    {
+        s_sharedCompositor = new CardFaceCompositor();
+    }
+    return s_sharedCompositor;
+}
+
+void CardFaceCompositor::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedCompositor);
+}
+
+CardFaceCompositor::CardFaceCompositor()
+    : _renderTexture(nullptr)
+    , _composedCount(0)
+{
+    std::fill(_faceFrames, _faceFrames + kMaxFaces, nullptr);
+}
+
+CardFaceCompositor::~CardFaceCompositor()
+{
+    for (SpriteFrame*& frame : _faceFrames)
+    {
+        CC_SAFE_RELEASE_NULL(frame);
+    }
+    CC_SAFE_RELEASE_NULL(_renderTexture);
+}
+
+int CardFaceCompositor::prepareFaces(const GameModel& gameModel)
+{
+    std::vector<int> slots;
+    bool pending[kMaxFaces] = {};
+    for (size_t cardId = 0; cardId < gameModel.getCardCount(); ++cardId)
+    {
+        int slot = slotOf(gameModel.getCard(static_cast<int>(cardId))->getCode());
+        if (!_faceFrames[slot] && !pending[slot])
+        {
+            pending[slot] = true;
+            slots.push_back(slot);
+        }
+    }
+    
+    if (!slots.empty() && ensureTexture())
+    {
+        composeFaces(slots);
+    }
+    return static_cast<int>(slots.size());
+}
+
+SpriteFrame* CardFaceCompositor::getFaceFrame(CardCode code)
+{
+    int slot = slotOf(code);
+    if (!_faceFrames[slot] && ensureTexture())
+    {
+        composeFaces(std::vector<int>(1, slot));
+    }
+    return _faceFrames[slot];
+}
+
+size_t CardFaceCompositor::getTextureBytes() const
+{
+    if (!_renderTexture)
+        return 0;
+    
+    Texture2D* texture = _renderTexture->getSprite()->getTexture();
+    return static_cast<size_t>(texture->getPixelsWide()) * texture->getPixelsHigh() * 4;
+}
+
+bool CardFaceCompositor::ensureTexture()
+{
+    if (_renderTexture)
+        return true;
+    
+    Size cell = cellSize();
+    _renderTexture = RenderTexture::create(static_cast<int>(cell.width * kColumns), static_cast<int>(cell.height * kRows),
+                                           Texture2D::PixelFormat::RGBA8888);
+    if (!_renderTexture)
+    {
+        CCLOG("CardFaceCompositor: cannot create face texture");
+        return false;
+    }
+    _renderTexture->retain();
+    
+    // 清空一次，之后每次合成只画新的格子，不再清除已合成的牌面
+    _renderTexture->beginWithClear(0, 0, 0, 0);
+    _renderTexture->end();
+    
+    Texture2D* texture = _renderTexture->getSprite()->getTexture();
+    CCLOG("CardFaceCompositor: %dx%d face texture, %.2f MB for up to %d faces",
+          texture->getPixelsWide(), texture->getPixelsHigh(), getTextureBytes() / (1024.0 * 1024.0), kMaxFaces);
+    return true;
+}
+
+void CardFaceCompositor::composeFaces(const std::vector<int>& slots)
+{
+    Texture2D* texture = _renderTexture->getSprite()->getTexture();
+    
+    // 节点在本帧渲染时才真正绘制，由自动释放池保留到帧末
+    _renderTexture->begin();
+    for (int slot : slots)
+    {
+        Rect rect = cellRect(slot);
+        Node* face = createFaceNode(slot);
+        
+        // 纹理第一行在绘制坐标的底部，上下翻转后精灵帧按普通图片的方向显示
+        face->setPosition(Vec2(rect.getMidX(), rect.getMidY()));
+        face->setScaleY(-1.0f);
+        face->visit();
+        
+        SpriteFrame* frame = SpriteFrame::createWithTexture(texture, rect);
+        frame->retain();
+        _faceFrames[slot] = frame;
+        ++_composedCount;
+    }
+    _renderTexture->end();
+}
+
+Node* CardFaceCompositor::createFaceNode(int slot) const
+{
+    CardFaceType face = static_cast<CardFaceType>(slot % CFT_NUM_CARD_FACE_TYPES);
+    CardSuitType suit = static_cast<CardSuitType>(slot / CFT_NUM_CARD_FACE_TYPES);
+    bool isRed = CardResConfig::isRedSuit(suit);
+    Size cardSize = CardResConfig::getCardSize();
+    
+    Node* node = Node::create();
+    
+    // 卡牌背景拉伸到卡牌尺寸
+    Sprite* background = createPart(CardResConfig::getCardBackgroundFrame(), Vec2::ZERO, 1.0f);
+    if (background)
+    {
+        background->setContentSize(cardSize);
+        node->addChild(background);
+    }
+    
+    // 大数字（中下部）、小数字（左上角）、花色（右上角），相对牌面中心
+    SpriteFrame* numberFrame = CardResConfig::getNumberFrame(face, isRed);
+    Sprite* parts[] = {
+        createPart(numberFrame, Vec2(0, -cardSize.height * 0.15f), 0.5f),
+        createPart(numberFrame, Vec2(-cardSize.width * 0.35f, cardSize.height * 0.35f), 0.25f),
+        createPart(CardResConfig::getSuitFrame(suit), Vec2(cardSize.width * 0.35f, cardSize.height * 0.35f), 0.7f),
+    };
+    for (Sprite* part : parts)
+    {
+        if (part)
+        {
+            node->addChild(part, 1);
+        }
+    }
+    return node;
+}
+
+int CardFaceCompositor::slotOf(CardCode code)
+{
+    int face = code.getFace();
+    int suit = code.getSuit();
+    if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES)
+    {
+        face = CFT_ACE;
+    }
+    if (suit < CST_CLUBS || suit >= CST_NUM_CARD_SUIT_TYPES)
+    {
+        suit = CST_HEARTS;
+    }
+    return suit * CFT_NUM_CARD_FACE_TYPES + face;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file CardFaceCompositor.h
+ * @brief 牌面合成器头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把卡牌背景、大小数字和花色预先合成到一张离屏纹理上，每种点数/花色组合只合成一次，
+ * 卡牌视图只需一个精灵
+ */
+
+#ifndef __CARD_FACE_COMPOSITOR_H__
+#define __CARD_FACE_COMPOSITOR_H__
+
+#include "cocos2d.h"
+#include "../models/GameModel.h"
+#include "../utils/CardCode.h"
+#include <vector>
+
+/**
+ * @class CardFaceCompositor
+ * @brief 牌面合成器
+ *
+ * - 所有牌面合成在同一张RenderTexture上，按 花色*13+点数 固定分配格子，最多52个牌面，
+ *   纹理在第一次合成时按52格一次分配，显存上限固定，创建时输出占用字节数
+ * - 关卡加载时prepareFaces合成关卡用到、之前未合成的牌面，一次begin/end完成；
+ *   getFaceFrame遇到未合成的牌面时立即补合成
+ * - 牌面布局与原先卡牌视图的四个子精灵相同，按卡牌尺寸（CardResConfig::getCardSize）合成
+ * - RenderTexture的纹理行序与普通图片上下相反，合成时把牌面上下翻转，精灵帧可以直接使用；
+ *   合成结果是预乘Alpha，使用牌面的精灵需设置BlendFunc::ALPHA_PREMULTIPLIED
+ */
+class CardFaceCompositor
+{
+public:
+    static const int kMaxFaces = CFT_NUM_CARD_FACE_TYPES * CST_NUM_CARD_SUIT_TYPES;
+    
+    static CardFaceCompositor* getInstance();
+    
+    // 释放牌面纹理，已使用牌面的精灵仍持有纹理引用
+    static void destroyInstance();
+    
+    /**
+     * 合成关卡中所有卡牌的牌面，已合成的跳过
+     * @param gameModel 新关卡的游戏模型
+     * @return 本次新合成的牌面数
+     */
+    int prepareFaces(const GameModel& gameModel);
+    
+    /**
+     * 获取牌面精灵帧，O(1)；未合成时立即合成
+     * @param code 卡牌编码，无效点数按A、无效花色按红桃处理（与CardResConfig一致）
+     * @return 牌面精灵帧，纹理创建失败时返回nullptr
+     */
+    cocos2d::SpriteFrame* getFaceFrame(CardCode code);
+    
+    // 已合成的牌面数
+    int getComposedCount() const { return _composedCount; }
+    
+    // 牌面纹理占用的显存字节数，未分配时为0
+    size_t getTextureBytes() const;
+
+private:
+    CardFaceCompositor();
+    ~CardFaceCompositor();
+    
+    // 按牌面格子数分配离屏纹理并清空
+    bool ensureTexture();
+    
+    // 在一次begin/end中合成给定格子的牌面
+    void composeFaces(const std::vector<int>& slots);
+    
+    // 创建一个牌面的节点树（以牌面中心为原点）
+    cocos2d::Node* createFaceNode(int slot) const;
+    
+    // 卡牌编码对应的格子，0..kMaxFaces-1
+    static int slotOf(CardCode code);
+    
+    cocos2d::RenderTexture* _renderTexture;             // 牌面纹理（持有引用）
+    cocos2d::SpriteFrame* _faceFrames[kMaxFaces];       // 已合成牌面的精灵帧（持有引用），未合成为nullptr
+    int _composedCount;                                 // 已合成的牌面数
+};
+
+#endif // __CARD_FACE_COMPOSITOR_H__
@@ -0,0 +1,149 @@
+#include "CardHitGrid.h"
+#include <algorithm>
+#include <cmath>
+
+USING_NS_CC;
+
+CardHitGrid::CardHitGrid()
+    : _columns(1)
+    , _rows(1)
+    , _cardCount(0)
+{
+    _cells.resize(1);
+    _cellSize = Size(1.0f, 1.0f);
+}
+
+void CardHitGrid::reset(const Rect& bounds, const Size& cellSize)
+{
+    _origin = bounds.origin;
+    _cellSize = Size(std::max(cellSize.width, 1.0f), std::max(cellSize.height, 1.0f));
+    _columns = std::max(1, static_cast<int>(std::ceil(bounds.size.width / _cellSize.width)));
+    _rows = std::max(1, static_cast<int>(std::ceil(bounds.size.height / _cellSize.height)));
+    
+    _cells.assign(static_cast<size_t>(_columns) * _rows, std::vector<int>());
+    _entries.clear();
+    _cardCount = 0;
+}
+
+void CardHitGrid::clear()
+{
+    for (std::vector<int>& cell : _cells)
+    {
+        cell.clear();
+    }
+    _entries.clear();
+    _cardCount = 0;
+}
+
+void CardHitGrid::update(int cardId, const Rect& rect, int64_t priority)
+{
+    if (cardId < 0)
+        return;
+    
+    if (cardId >= static_cast<int>(_entries.size()))
+    {
+        _entries.resize(cardId + 1);
+    }
+    
+    Entry& entry = _entries[cardId];
+    int firstColumn = columnOf(rect.getMinX());
+    int firstRow = rowOf(rect.getMinY());
+    int lastColumn = columnOf(rect.getMaxX());
+    int lastRow = rowOf(rect.getMaxY());
+    
+    // 所占格子不变时只更新矩形和优先级
+    if (!entry.active || firstColumn != entry.firstColumn || firstRow != entry.firstRow
+        || lastColumn != entry.lastColumn || lastRow != entry.lastRow)
+    {
+        unlink(cardId);
+        for (int row = firstRow; row <= lastRow; ++row)
+        {
+            for (int column = firstColumn; column <= lastColumn; ++column)
+            {
+                _cells[row * _columns + column].push_back(cardId);
+            }
+        }
+        entry.firstColumn = firstColumn;
+        entry.firstRow = firstRow;
+        entry.lastColumn = lastColumn;
+        entry.lastRow = lastRow;
+        entry.active = true;
+        ++_cardCount;
+    }
+    entry.rect = rect;
+    entry.priority = priority;
+}
+
+void CardHitGrid::remove(int cardId)
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_entries.size()))
+        return;
+    
+    unlink(cardId);
+}
+
+int CardHitGrid::hitTest(const Vec2& point, const std::function<bool(int)>& accept) const
+{
+    const std::vector<int>& cell = _cells[rowOf(point.y) * _columns + columnOf(point.x)];
+    
+    int hitCardId = -1;
+    int64_t hitPriority = 0;
+    for (int cardId : cell)
+    {
+        const Entry& entry = _entries[cardId];
+        if (hitCardId >= 0 && entry.priority <= hitPriority)
+            continue;
+        
+        if (entry.rect.containsPoint(point) && (!accept || accept(cardId)))
+        {
+            hitCardId = cardId;
+            hitPriority = entry.priority;
+        }
+    }
+    return hitCardId;
+}
+
+bool CardHitGrid::contains(int cardId, const Vec2& point) const
+{
+    if (cardId < 0 || cardId >= static_cast<int>(_entries.size()))
+        return false;
+    
+    const Entry& entry = _entries[cardId];
+    return entry.active && entry.rect.containsPoint(point);
+}
+
+int CardHitGrid::columnOf(float x) const
+{
+    int column = static_cast<int>(std::floor((x - _origin.x) / _cellSize.width));
+    return std::min(std::max(column, 0), _columns - 1);
+}
+
+int CardHitGrid::rowOf(float y) const
+{
+    int row = static_cast<int>(std::floor((y - _origin.y) / _cellSize.height));
+    return std::min(std::max(row, 0), _rows - 1);
+}
+
+void CardHitGrid::unlink(int cardId)
+{
+    Entry& entry = _entries[cardId];
+    if (!entry.active)
+        return;
+    
+    // 格子中的顺序无关紧要，与末尾交换后弹出
+    for (int row = entry.firstRow; row <= entry.lastRow; ++row)
+    {
+        for (int column = entry.firstColumn; column <= entry.lastColumn; ++column)
+        {
+            std::vector<int>& cell = _cells[row * _columns + column];
+            auto it = std::find(cell.begin(), cell.end(), cardId);
+            if (it != cell.end())
+            {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+    entry.active = false;
+    --_cardCount;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file CardHitGrid.h
+ * @brief 卡牌点击检测网格头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把卡牌矩形登记到均匀网格中，点击时只检查触点所在格子里的卡牌，
+ * 取叠放顺序最上面的一张
+ */
+
+#ifndef __CARD_HIT_GRID_H__
+#define __CARD_HIT_GRID_H__
+
+#include "cocos2d.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @class CardHitGrid
+ * @brief 卡牌点击检测网格
+ *
+ * - 区域按固定格子尺寸（取卡牌尺寸）划分，每张卡牌登记到矩形覆盖的格子中，一张卡牌最多占4格；
+ *   区域外的矩形按最近的边缘格子登记，检测结果仍然准确
+ * - 卡牌按cardId下标保存矩形、叠放优先级和所占格子，更新和移除只改动相关格子
+ * - hitTest只遍历一个格子，耗时取决于叠在该处的卡牌数，与卡牌总数无关
+ * - 叠放优先级越大越靠上，由调用方按节点的叠放顺序给出
+ */
+class CardHitGrid
+{
+public:
+    CardHitGrid();
+    
+    /**
+     * 重新划分网格并清空所有卡牌
+     * @param bounds 网格覆盖的区域（与卡牌矩形同一坐标系）
+     * @param cellSize 格子尺寸
+     */
+    void reset(const cocos2d::Rect& bounds, const cocos2d::Size& cellSize);
+    
+    // 清空所有卡牌，保留网格划分
+    void clear();
+    
+    /**
+     * 登记或更新卡牌
+     * @param cardId 卡牌ID
+     * @param rect 卡牌矩形
+     * @param priority 叠放优先级，越大越靠上
+     */
+    void update(int cardId, const cocos2d::Rect& rect, int64_t priority);
+    
+    // 移除卡牌，未登记时忽略
+    void remove(int cardId);
+    
+    /**
+     * 查找包含触点的最上面一张卡牌
+     * @param point 触点（与卡牌矩形同一坐标系）
+     * @param accept 可选的过滤条件，返回false的卡牌不响应点击，触点落到下面的卡牌
+     * @return 卡牌ID，没有卡牌时返回-1
+     */
+    int hitTest(const cocos2d::Vec2& point, const std::function<bool(int)>& accept = nullptr) const;
+    
+    // 已登记的卡牌矩形是否包含触点
+    bool contains(int cardId, const cocos2d::Vec2& point) const;
+    
+    // 已登记的卡牌数
+    size_t getCardCount() const { return _cardCount; }
+
+private:
+    /**
+     * 卡牌的登记信息
+     */
+    struct Entry
+    {
+        cocos2d::Rect rect;
+        int64_t priority;
+        int firstColumn, firstRow;      // 所占格子范围（含两端）
+        int lastColumn, lastRow;
+        bool active;                    // 是否已登记
+        
+        Entry() : priority(0), firstColumn(0), firstRow(0), lastColumn(-1), lastRow(-1), active(false) {}
+    };
+    
+    // 坐标所在的列/行，区域外取最近的边缘
+    int columnOf(float x) const;
+    int rowOf(float y) const;
+    
+    // 从所占格子中摘除卡牌
+    void unlink(int cardId);
+    
+    std::vector<Entry> _entries;                    // 下标即cardId
+    std::vector<std::vector<int>> _cells;           // 每个格子中的卡牌ID，按行优先排列
+    cocos2d::Vec2 _origin;                          // 网格左下角
+    cocos2d::Size _cellSize;
+    int _columns;
+    int _rows;
+    size_t _cardCount;
+};
+
+#endif // __CARD_HIT_GRID_H__
@@ -1,26 +1,21 @@
 #include "CardView.h"
+#include "CardFaceCompositor.h"
 
 USING_NS_CC;
 
+namespace
+{
+    const int kMoveActionTag = 0x4D0E;     // 移动动画动作标签
+}
+
 CardView::CardView()
     : _cardModel(nullptr)
     , _cardId(-1)
-    , _backgroundSprite(nullptr)
-    , _bigNumberSprite(nullptr)
-    , _smallNumberSprite(nullptr)
-    , _suitSprite(nullptr)
-    , _touchListener(nullptr)
-    , _touchEnabled(true)
 {
 }
 
 CardView::~CardView()
 {
-    if (_touchListener)
-    {
-        _eventDispatcher->removeEventListener(_touchListener);
-        _touchListener = nullptr;
-    }
 }
 
 CardView* CardView::create(const CardModel* cardModel)
@@ -37,7 +32,7 @@ CardView* CardView::create(const CardModel* cardModel)
 
 bool CardView::init(const CardModel* cardModel)
 {
-    if (!Node::init())
+    if (!Sprite::init())
         return false;
     
     if (!cardModel)
@@ -47,7 +42,6 @@ bool CardView::init(const CardModel* cardModel)
     _cardId = cardModel->getCardId();
     
     createCardUI();
-    setupTouchListener();
     updateDisplay(cardModel);
     
     return true;
@@ -55,94 +49,11 @@ bool CardView::init(const CardModel* cardModel)
 
 void CardView::createCardUI()
 {
-    Size cardSize = CardResConfig::getCardSize();
-    
-    // 设置锚点为中心，确保触摸检测正确
-    this->setAnchorPoint(Vec2(0.5f, 0.5f));
-    
-    // 创建卡牌背景
-    _backgroundSprite = Sprite::create(CardResConfig::getCardBackgroundPath());
-    if (_backgroundSprite)
-    {
-        _backgroundSprite->setContentSize(cardSize);
-        _backgroundSprite->setAnchorPoint(Vec2(0.5f, 0.5f)); // 背景也设置中心锚点
-        _backgroundSprite->setPosition(Vec2(0, 0)); // 背景位置应该在节点中心，即(0,0)
-        this->addChild(_backgroundSprite);
-    }
-    
-    // 创建大数字精灵（中下部位置）- 相对于中心锚点
-    _bigNumberSprite = Sprite::create();
-    if (_bigNumberSprite)
-    {
-        _bigNumberSprite->setPosition(Vec2(0, -cardSize.height * 0.15f)); // 相对于中心向下偏移
-        _bigNumberSprite->setScale(0.5f);
-        this->addChild(_bigNumberSprite, 1);
-    }
-    
-    // 创建小数字精灵（左上角）- 相对于中心锚点
-    _smallNumberSprite = Sprite::create();
-    if (_smallNumberSprite)
-    {
-        _smallNumberSprite->setPosition(Vec2(-cardSize.width * 0.35f, cardSize.height * 0.35f)); // 相对于中心向左上
-        _smallNumberSprite->setScale(0.25f);
-        this->addChild(_smallNumberSprite, 1);
-    }
-    
-    // 创建花色精灵（右上角）- 相对于中心锚点
-    _suitSprite = Sprite::create();
-    if (_suitSprite)
-    {
-        _suitSprite->setPosition(Vec2(cardSize.width * 0.35f, cardSize.height * 0.35f)); // 相对于中心向右上
-        _suitSprite->setScale(0.7f);
-        this->addChild(_suitSprite, 1);
-    }
-    
-    this->setContentSize(cardSize);
-}
-
-void CardView::setupTouchListener()
-{
-    _touchListener = EventListenerTouchOneByOne::create();
-    _touchListener->setSwallowTouches(true);
-    
-    _touchListener->onTouchBegan = [this](Touch* touch, Event* event) -> bool {
-        return this->onTouchBegan(touch, event);
-    };
-    
-    _touchListener->onTouchEnded = [this](Touch* touch, Event* event) {
-        this->onTouchEnded(touch, event);
-    };
-    
-    _eventDispatcher->addEventListenerWithSceneGraphPriority(_touchListener, this);
-}
-
-bool CardView::onTouchBegan(Touch* touch, Event* event)
-{
-    if (!_touchEnabled || !_cardModel || !_cardModel->isVisible())
-        return false;
-    
-    Vec2 locationInNode = this->convertToNodeSpace(touch->getLocation());
-    Size size = this->getContentSize();
-    // 使用以锚点为中心的边界框
-    Rect rect = Rect(-size.width * 0.5f, -size.height * 0.5f, size.width, size.height);
-    
-    return rect.containsPoint(locationInNode);
-}
-
-void CardView::onTouchEnded(Touch* touch, Event* event)
-{
-    if (!_touchEnabled || !_cardModel || !_cardModel->isVisible())
-        return;
-    
-    Vec2 locationInNode = this->convertToNodeSpace(touch->getLocation());
-    Size size = this->getContentSize();
-    // 使用以锚点为中心的边界框
-    Rect rect = Rect(-size.width * 0.5f, -size.height * 0.5f, size.width, size.height);
-    
-    if (rect.containsPoint(locationInNode) && _onClickCallback)
-    {
-        _onClickCallback(_cardId);
-    }
+    // 牌面是一整张预合成的图像，卡牌只有这一个节点。
+    // 锚点取右上角：原先四个子精灵以节点原点（内容区左下角）为中心摆放，
+    // 牌面中心位于position左下方半张卡牌处，这里保持相同的显示位置和缩放中心
+    this->setAnchorPoint(Vec2(1.0f, 1.0f));
+    this->setContentSize(CardResConfig::getCardSize());
 }
 
 void CardView::updateDisplay(const CardModel* cardModel)
@@ -159,26 +70,14 @@ void CardView::updateDisplay(const CardModel* cardModel)
     // 更新可见性
     this->setVisible(cardModel->isVisible());
     
-    bool isRed = CardResConfig::isRedSuit(cardModel->getSuit());
-    std::string numberPath = CardResConfig::getNumberImagePath(cardModel->getFace(), isRed);
-    
-    // 更新大数字显示（中下部）
-    if (_bigNumberSprite)
-    {
-        _bigNumberSprite->setTexture(numberPath);
-    }
-    
-    // 更新小数字显示（左上角）
-    if (_smallNumberSprite)
+    // 切换到预合成的牌面，所有卡牌共用一张牌面纹理
+    SpriteFrame* faceFrame = CardFaceCompositor::getInstance()->getFaceFrame(cardModel->getCode());
+    if (faceFrame)
     {
-        _smallNumberSprite->setTexture(numberPath);
-    }
-    
-    // 更新花色显示（右上角）
-    if (_suitSprite)
-    {
-        std::string suitPath = CardResConfig::getSuitImagePath(cardModel->getSuit());
-        _suitSprite->setTexture(suitPath);
+        this->setSpriteFrame(faceFrame);
+        
+        // 牌面纹理是预乘Alpha，setSpriteFrame会按纹理重置混合方式
+        this->setBlendFunc(BlendFunc::ALPHA_PREMULTIPLIED);
     }
 }
 
@@ -187,25 +86,28 @@ void CardView::playMoveAnimation(const Vec2& targetPosition, float duration, con
     if (!_cardModel)
         return;
     
-    auto moveAction = MoveTo::create(duration, targetPosition);
+    // 新的移动取代尚未播放完的移动，避免两个MoveTo争夺位置
+    stopMoveAnimation();
     
+    FiniteTimeAction* action = MoveTo::create(duration, targetPosition);
     if (callback)
     {
-        auto sequence = Sequence::create(moveAction, CallFunc::create(callback), nullptr);
-        this->runAction(sequence);
-    }
-    else
-    {
-        this->runAction(moveAction);
+        action = Sequence::create(action, CallFunc::create(callback), nullptr);
     }
+    action->setTag(kMoveActionTag);
+    this->runAction(action);
 }
 
-void CardView::setOnClickCallback(const std::function<void(int)>& callback)
+void CardView::stopMoveAnimation()
 {
-    _onClickCallback = callback;
+    this->stopActionByTag(kMoveActionTag);
 }
 
-void CardView::setTouchEnabled(bool enabled)
+void CardView::resetForReuse()
 {
-    _touchEnabled = enabled;
+    this->stopAllActions();
+    this->setScale(1.0f);
+    
+    _cardModel = nullptr;
+    _cardId = -1;
 }
@@ -8,9 +8,11 @@
 
 /**
  * 卡牌视图类
- * 负责单张卡牌的显示和交互
+ * 负责单张卡牌的显示
+ * 卡牌本身就是一个精灵，显示CardFaceCompositor预合成的牌面，没有子节点
+ * 卡牌不监听触摸，点击由GameView统一检测
  */
-class CardView : public cocos2d::Node
+class CardView : public cocos2d::Sprite
 {
 public:
     CardView();
@@ -47,54 +49,31 @@ public:
                           const std::function<void()>& callback = nullptr);
     
     /**
-     * 设置卡牌点击回调
-     * @param callback 点击回调函数，参数为卡牌ID
+     * 停止正在播放的移动动画（完成回调不再触发），卡牌停在当前位置
      */
-    void setOnClickCallback(const std::function<void(int)>& callback);
+    void stopMoveAnimation();
     
     /**
-     * 获取卡牌ID
-     * @return 卡牌唯一标识
+     * 回收到对象池前重置：停止所有动作，恢复缩放，解除与卡牌模型的绑定
+     * 之后通过updateDisplay绑定新的卡牌模型即可再次使用
      */
-    int getCardId() const { return _cardId; }
+    void resetForReuse();
     
     /**
-     * 设置卡牌是否可点击
-     * @param enabled true表示可点击
+     * 获取卡牌ID
+     * @return 卡牌唯一标识
      */
-    void setTouchEnabled(bool enabled);
+    int getCardId() const { return _cardId; }
 
 private:
     /**
-     * 创建卡牌UI组件
+     * 设置卡牌的锚点和尺寸
      */
     void createCardUI();
-    
-    /**
-     * 设置触摸事件监听
-     */
-    void setupTouchListener();
-    
-    /**
-     * 处理触摸事件
-     */
-    bool onTouchBegan(cocos2d::Touch* touch, cocos2d::Event* event);
-    void onTouchEnded(cocos2d::Touch* touch, cocos2d::Event* event);
 
 private:
     const CardModel* _cardModel;                    // 卡牌数据模型（只读引用）
     int _cardId;                                    // 卡牌ID（缓存）
-    
-    // UI组件
-    cocos2d::Sprite* _backgroundSprite;             // 背景精灵
-    cocos2d::Sprite* _bigNumberSprite;              // 大数字精灵（中下部）
-    cocos2d::Sprite* _smallNumberSprite;            // 小数字精灵（左上角）
-    cocos2d::Sprite* _suitSprite;                   // 花色精灵（右上角）
-    
-    // 交互
-    cocos2d::EventListenerTouchOneByOne* _touchListener;  // 触摸监听器
-    std::function<void(int)> _onClickCallback;            // 点击回调
-    bool _touchEnabled;                                   // 是否可点击
 };
 
 #endif // __CARD_VIEW_H__
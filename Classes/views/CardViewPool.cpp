@@ -0,0 +1,56 @@
+#include "CardViewPool.h"
+
+USING_NS_CC;
+
+CardViewPool::CardViewPool()
+    : _createdCount(0)
+    , _reusedCount(0)
+{
+}
+
+CardViewPool::~CardViewPool()
+{
+    clear();
+}
+
+CardView* CardViewPool::acquire(const CardModel* cardModel)
+{
+    if (!cardModel)
+        return nullptr;
+    
+    if (_freeViews.empty())
+    {
+        CardView* cardView = CardView::create(cardModel);
+        if (cardView)
+        {
+            ++_createdCount;
+        }
+        return cardView;
+    }
+    
+    // 移出对象池前先交给自动释放池，调用方加入场景后由父节点持有
+    CardView* cardView = _freeViews.back();
+    cardView->retain();
+    cardView->autorelease();
+    _freeViews.popBack();
+    
+    cardView->updateDisplay(cardModel);
+    ++_reusedCount;
+    return cardView;
+}
+
+void CardViewPool::recycle(CardView* cardView)
+{
+    if (!cardView)
+        return;
+    
+    // 先由对象池持有，再从父节点摘下，避免引用计数归零
+    _freeViews.pushBack(cardView);
+    cardView->resetForReuse();
+    cardView->removeFromParentAndCleanup(false);
+}
+
+void CardViewPool::clear()
+{
+    _freeViews.clear();
+}
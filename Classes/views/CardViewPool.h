@@ -0,0 +1,62 @@
+/**
+ * @file CardViewPool.h
+ * @brief 卡牌视图对象池头文件
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 回收不再显示的CardView，下次需要时重新绑定到新的卡牌模型，
+ * 关卡切换和撤销不再反复创建节点和精灵
+ */
+
+#ifndef __CARD_VIEW_POOL_H__
+#define __CARD_VIEW_POOL_H__
+
+#include "cocos2d.h"
+#include "CardView.h"
+
+/**
+ * @class CardViewPool
+ * @brief 卡牌视图对象池
+ *
+ * - 空闲视图保存在cocos2d::Vector中，由对象池持有引用，脱离场景后不会被释放
+ * - acquire优先取空闲视图，通过CardView::updateDisplay绑定新的卡牌模型，没有空闲视图时才创建
+ * - recycle重置视图的动作和状态后从父节点摘下
+ * - 对象池由GameController持有，生命周期长于GameView，关卡之间复用同一批视图；
+ *   视图总数达到关卡的最大卡牌数后，切换关卡不再分配节点
+ */
+class CardViewPool
+{
+public:
+    CardViewPool();
+    ~CardViewPool();
+    
+    /**
+     * 取出一个绑定到卡牌模型的视图
+     * @param cardModel 卡牌数据模型（只读）
+     * @return 与CardView::create相同，返回autorelease的视图，由调用方加入场景
+     */
+    CardView* acquire(const CardModel* cardModel);
+    
+    /**
+     * 回收视图：停止动作、恢复初始状态并从父节点移除
+     * @param cardView 不再显示的视图
+     */
+    void recycle(CardView* cardView);
+    
+    // 释放所有空闲视图
+    void clear();
+    
+    // 空闲视图数
+    size_t getFreeCount() const { return _freeViews.size(); }
+    
+    // 累计创建/复用的视图数，用于确认关卡切换时没有新分配
+    size_t getCreatedCount() const { return _createdCount; }
+    size_t getReusedCount() const { return _reusedCount; }
+
+private:
+    cocos2d::Vector<CardView*> _freeViews;          // 空闲视图（对象池持有引用）
+    size_t _createdCount;                           // 累计创建的视图数
+    size_t _reusedCount;                            // 累计复用的视图数
+};
+
+#endif // __CARD_VIEW_POOL_H__
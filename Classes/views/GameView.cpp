@@ -7,25 +7,54 @@ const Vec2 GameView::kStackPosition = Vec2(250, 400);  // 底牌备用牌区 - 
 const Vec2 GameView::kTrayPosition = Vec2(550, 400);   // 底牌区 - 右移
 const Vec2 GameView::kUndoButtonPosition = Vec2(600, 300);
 
+namespace
+{
+    const int kHintActionTag = 0x4E17;     // 提示高亮动作标签
+    const int kCardZOrder = 1;             // 普通卡牌层级
+    const int kTrayCardZOrder = 5;         // 底牌层级，压在其他卡牌之上
+    const int kZOrderLayerSpan = 1 << 20;  // 每个层级内按cardId排列的范围
+    
+    /**
+     * 卡牌节点的层级：同一层级内按cardId（即摆放顺序）叠放，后摆放的压在上面，
+     * 与覆盖关系和手牌堆顺序一致，不受视图创建或换区先后影响
+     */
+    int cardZOrder(int cardId, bool isTrayCard)
+    {
+        CCASSERT(cardId >= 0 && cardId < kZOrderLayerSpan, "card id exceeds the z-order layer span");
+        return (isTrayCard ? kTrayCardZOrder : kCardZOrder) * kZOrderLayerSpan + cardId;
+    }
+}
+
 GameView::GameView()
     : _gameModel(nullptr)
+    , _cardViewPool(nullptr)
     , _playfieldNode(nullptr)
     , _stackNode(nullptr)
     , _trayNode(nullptr)
     , _undoButton(nullptr)
+    , _redoButton(nullptr)
+    , _hintButton(nullptr)
+    , _hintCardId(-1)
     , _currentTrayCardId(-1)
+    , _cardTouchListener(nullptr)
+    , _touchedCardId(-1)
 {
 }
 
 GameView::~GameView()
 {
-    _cardViews.clear();
+    if (_cardTouchListener)
+    {
+        _eventDispatcher->removeEventListener(_cardTouchListener);
+        _cardTouchListener = nullptr;
+    }
+    _cardDisplays.clear();
 }
 
-GameView* GameView::create(const GameModel* gameModel)
+GameView* GameView::create(const GameModel* gameModel, CardViewPool* cardViewPool)
 {
     GameView* ret = new GameView();
-    if (ret && ret->init(gameModel))
+    if (ret && ret->init(gameModel, cardViewPool))
     {
         ret->autorelease();
         return ret;
@@ -34,7 +63,7 @@ GameView* GameView::create(const GameModel* gameModel)
     return nullptr;
 }
 
-bool GameView::init(const GameModel* gameModel)
+bool GameView::init(const GameModel* gameModel, CardViewPool* cardViewPool)
 {
     if (!Layer::init())
         return false;
@@ -43,8 +72,10 @@ bool GameView::init(const GameModel* gameModel)
         return false;
     
     _gameModel = gameModel;
+    _cardViewPool = cardViewPool;
     
     createUI();
+    setupTouchListener();
     updateDisplay(gameModel);
     
     return true;
@@ -58,6 +89,8 @@ void GameView::createUI()
     createBackgroundAreas();
     createGameAreas();
     createUndoButton();
+    createRedoButton();
+    createHintButton();
 }
 
 void GameView::createBackgroundAreas()
@@ -139,82 +172,307 @@ void GameView::createUndoButton()
     this->addChild(_undoButton, 10);
 }
 
+void GameView::createRedoButton()
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+    
+    auto redoLabel = Label::createWithSystemFont("重做", "Arial", 64);
+    if (!redoLabel) {
+        redoLabel = Label::createWithSystemFont("REDO", "Arial", 64);
+    }
+    
+    redoLabel->setColor(Color3B::WHITE);
+    redoLabel->enableOutline(Color4B::BLACK, 2);
+    
+    auto redoMenuItem = MenuItemLabel::create(redoLabel, [this](Ref* sender) {
+        if (_onRedoClickCallback)
+            _onRedoClickCallback();
+    });
+    
+    _redoButton = Menu::create(redoMenuItem, nullptr);
+    
+    // 与撤销按钮同一列，位于其下方
+    float lowerAreaHeight = visibleSize.height * 0.3f;
+    float buttonY = origin.y + lowerAreaHeight * 0.22f;
+    float buttonX = origin.x + visibleSize.width * 0.85f;
+    
+    _redoButton->setPosition(Vec2(buttonX, buttonY));
+    this->addChild(_redoButton, 10);
+}
+
+void GameView::createHintButton()
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+    
+    auto hintLabel = Label::createWithSystemFont("提示", "Arial", 64);
+    if (!hintLabel) {
+        hintLabel = Label::createWithSystemFont("HINT", "Arial", 64);
+    }
+    
+    hintLabel->setColor(Color3B::WHITE);
+    hintLabel->enableOutline(Color4B::BLACK, 2);
+    
+    auto hintMenuItem = MenuItemLabel::create(hintLabel, [this](Ref* sender) {
+        if (_onHintClickCallback)
+            _onHintClickCallback();
+    });
+    
+    _hintButton = Menu::create(hintMenuItem, nullptr);
+    
+    // 与撤销按钮同一列，位于其上方
+    float lowerAreaHeight = visibleSize.height * 0.3f;
+    float buttonY = origin.y + lowerAreaHeight * 0.78f;
+    float buttonX = origin.x + visibleSize.width * 0.85f;
+    
+    _hintButton->setPosition(Vec2(buttonX, buttonY));
+    this->addChild(_hintButton, 10);
+}
+
 void GameView::updateDisplay(const GameModel* gameModel)
 {
     if (!gameModel)
         return;
     
-    _gameModel = gameModel;
+    // 局面已变化，旧的提示作废
+    clearHint();
+    _lastUpdateStats = DisplayUpdateStats();
+    
+    // 首次显示或换了模型，卡牌ID与现有视图不再对应
+    if (gameModel != _gameModel || _cardDisplays.size() != gameModel->getCardCount())
+    {
+        _gameModel = gameModel;
+        rebuildCardViews();
+        return;
+    }
+    
+    // 只有换过区域的卡牌需要比对
+    for (int cardId : gameModel->getChangedCards())
+    {
+        syncCardView(cardId);
+    }
+    _currentTrayCardId = gameModel->getTrayCardId();
+}
+
+void GameView::rebuildCardViews()
+{
+    recycleCardViews();
+    _cardDisplays.assign(_gameModel->getCardCount(), CardDisplay());
+    _lastUpdateStats.fullRebuild = true;
     
-    // 清除所有现有卡牌视图，强制重新创建
-    for (auto& pair : _cardViews)
+    // 按cardId（摆放顺序）创建：游戏区卡牌数组在移除卡牌时会打乱顺序，不能代表叠放顺序
+    int cardCount = static_cast<int>(_gameModel->getCardCount());
+    for (int cardId = 0; cardId < cardCount; ++cardId)
     {
-        pair.second->removeFromParent();
+        if (_gameModel->getCardZone(cardId) != CZ_NONE)
+        {
+            syncCardView(cardId);
+        }
     }
-    _cardViews.clear();
-    _currentTrayCardId = -1;
+    _currentTrayCardId = _gameModel->getTrayCardId();
+}
+
+void GameView::syncCardView(int cardId)
+{
+    const CardModel* cardModel = _gameModel->getCard(cardId);
+    if (!cardModel)
+        return;
+    
+    ++_lastUpdateStats.cardsChecked;
+    CardDisplay& display = _cardDisplays[cardId];
+    CardZone zone = _gameModel->getCardZone(cardId);
     
-    // 重新创建游戏区域卡牌
-    const auto& playfieldCards = gameModel->getPlayfieldCards();
-    for (const auto& card : playfieldCards)
+    // 离开所有区域的卡牌不再显示
+    if (zone == CZ_NONE)
+    {
+        if (display.view)
+        {
+            removeCardView(cardId);
+            ++_lastUpdateStats.viewsRemoved;
+        }
+        return;
+    }
+    
+    if (!display.view)
+    {
+        addCardView(cardModel);
+        ++_lastUpdateStats.viewsCreated;
+        return;
+    }
+    
+    bool updated = false;
+    int zOrder = cardZOrder(cardId, zone == CZ_TRAY);
+    if (display.zOrder != zOrder)
+    {
+        display.view->setLocalZOrder(zOrder);
+        display.zOrder = zOrder;
+        updated = true;
+    }
+    
+    // 目标位置与模型一致时不动节点，正在播放的移动动画继续
+    if (display.position != cardModel->getPosition())
+    {
+        display.view->stopMoveAnimation();
+        display.view->setPosition(cardModel->getPosition());
+        display.position = cardModel->getPosition();
+        updated = true;
+    }
+    
+    if (display.visible != cardModel->isVisible())
+    {
+        display.view->setVisible(cardModel->isVisible());
+        display.visible = cardModel->isVisible();
+        updated = true;
+    }
+    
+    if (updated)
+    {
+        updateHitRect(cardId);
+        ++_lastUpdateStats.viewsUpdated;
+    }
+}
+
+void GameView::updateHitRect(int cardId)
+{
+    const CardDisplay& display = _cardDisplays[cardId];
+    if (!display.view || !display.visible)
     {
-        addCardView(card.get());
+        _hitGrid.remove(cardId);
+        return;
     }
     
-    // 重新创建手牌堆卡牌
-    const auto& stackCards = gameModel->getStackCards();
-    for (const auto& card : stackCards)
+    // 按目标位置和锚点计算卡牌矩形，提示高亮的缩放不计入
+    Rect rect(display.position - display.view->getAnchorPointInPoints(), display.view->getContentSize());
+    _hitGrid.update(cardId, rect, display.zOrder);
+}
+
+void GameView::setupTouchListener()
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+    
+    // 游戏区节点位于原点，网格覆盖可见区域；格子取卡牌尺寸，一张卡牌最多占4格
+    _hitGrid.reset(Rect(origin, visibleSize), CardResConfig::getCardSize());
+    
+    _cardTouchListener = EventListenerTouchOneByOne::create();
+    _cardTouchListener->setSwallowTouches(true);
+    
+    _cardTouchListener->onTouchBegan = [this](Touch* touch, Event* event) -> bool {
+        return this->onTouchBegan(touch, event);
+    };
+    
+    _cardTouchListener->onTouchEnded = [this](Touch* touch, Event* event) {
+        this->onTouchEnded(touch, event);
+    };
+    
+    _cardTouchListener->onTouchCancelled = [this](Touch* touch, Event* event) {
+        _touchedCardId = -1;
+    };
+    
+    // 按钮是视图的子节点，先于视图收到触摸
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(_cardTouchListener, this);
+}
+
+bool GameView::onTouchBegan(Touch* touch, Event* event)
+{
+    Vec2 location = _playfieldNode->convertToNodeSpace(touch->getLocation());
+    
+    // 被压住的卡牌让触摸落到下面的卡牌，命中的是触点处最上面一张露出的卡牌
+    _touchedCardId = _hitGrid.hitTest(location, [this](int cardId) {
+        return this->isCardTouchable(cardId);
+    });
+    return _touchedCardId >= 0;
+}
+
+bool GameView::isCardTouchable(int cardId) const
+{
+    switch (_gameModel->getCardZone(cardId))
     {
-        addCardView(card.get());
+        case CZ_PLAYFIELD:
+            return _gameModel->isCardExposed(cardId);
+        case CZ_STACK:
+            return _gameModel->getStackCards().back() == cardId;
+        case CZ_TRAY:
+            return true;
+        default:
+            return false;
     }
+}
+
+void GameView::onTouchEnded(Touch* touch, Event* event)
+{
+    int cardId = _touchedCardId;
+    _touchedCardId = -1;
     
-    // 重新创建底牌
-    auto trayCard = gameModel->getTrayCard();
-    if (trayCard)
+    Vec2 location = _playfieldNode->convertToNodeSpace(touch->getLocation());
+    if (_hitGrid.contains(cardId, location) && _onCardClickCallback)
     {
-        addCardView(trayCard.get());
-        _currentTrayCardId = trayCard->getCardId();
+        _onCardClickCallback(cardId);
     }
 }
 
 void GameView::addCardView(const CardModel* cardModel)
 {
-    if (!cardModel || _cardViews.find(cardModel->getCardId()) != _cardViews.end())
+    if (!cardModel || getCardView(cardModel->getCardId()))
         return;
     
-    CardView* cardView = CardView::create(cardModel);
+    int cardId = cardModel->getCardId();
+    if (cardId >= static_cast<int>(_cardDisplays.size()))
+    {
+        _cardDisplays.resize(cardId + 1);
+    }
+    
+    CardView* cardView = _cardViewPool ? _cardViewPool->acquire(cardModel) : CardView::create(cardModel);
     if (cardView)
     {
-        cardView->setOnClickCallback(_onCardClickCallback);
+        // 底牌使用更高的层级
+        bool isTrayCard = _gameModel && _gameModel->getTrayCardId() == cardId;
+        int zOrder = cardZOrder(cardId, isTrayCard);
+        _playfieldNode->addChild(cardView, zOrder);
         
-        // 检查是否是底牌，如果是底牌则设置更高的z-order
-        if (_gameModel && _gameModel->getTrayCard() && _gameModel->getTrayCard()->getCardId() == cardModel->getCardId())
-        {
-            _playfieldNode->addChild(cardView, 5); // 底牌使用更高的层级
-        }
-        else
-        {
-            _playfieldNode->addChild(cardView, 1); // 普通卡牌使用较低层级
-        }
-        
-        _cardViews[cardModel->getCardId()] = cardView;
+        CardDisplay& display = _cardDisplays[cardId];
+        display.view = cardView;
+        display.position = cardModel->getPosition();
+        display.zOrder = zOrder;
+        display.visible = cardModel->isVisible();
+        updateHitRect(cardId);
     }
 }
 
 void GameView::removeCardView(int cardId)
 {
-    auto it = _cardViews.find(cardId);
-    if (it != _cardViews.end())
+    CardView* cardView = getCardView(cardId);
+    if (!cardView)
+        return;
+    
+    if (_cardViewPool)
+    {
+        _cardViewPool->recycle(cardView);
+    }
+    else
+    {
+        cardView->removeFromParent();
+    }
+    _cardDisplays[cardId] = CardDisplay();
+    _hitGrid.remove(cardId);
+}
+
+void GameView::recycleCardViews()
+{
+    clearHint();
+    for (size_t cardId = 0; cardId < _cardDisplays.size(); ++cardId)
     {
-        it->second->removeFromParent();
-        _cardViews.erase(it);
+        removeCardView(static_cast<int>(cardId));
     }
 }
 
 CardView* GameView::getCardView(int cardId) const
 {
-    auto it = _cardViews.find(cardId);
-    return (it != _cardViews.end()) ? it->second : nullptr;
+    if (cardId < 0 || cardId >= static_cast<int>(_cardDisplays.size()))
+        return nullptr;
+    
+    return _cardDisplays[cardId].view;
 }
 
 void GameView::playMatchAnimation(int cardId, const Vec2& targetPosition, const std::function<void()>& callback)
@@ -222,6 +480,8 @@ void GameView::playMatchAnimation(int cardId, const Vec2& targetPosition, const
     CardView* cardView = getCardView(cardId);
     if (cardView)
     {
+        _cardDisplays[cardId].position = targetPosition;
+        updateHitRect(cardId);
         cardView->playMoveAnimation(targetPosition, 0.3f, callback);
     }
 }
@@ -229,12 +489,6 @@ void GameView::playMatchAnimation(int cardId, const Vec2& targetPosition, const
 void GameView::setOnCardClickCallback(const std::function<void(int)>& callback)
 {
     _onCardClickCallback = callback;
-    
-    // 更新所有现有卡牌视图的回调
-    for (auto& pair : _cardViews)
-    {
-        pair.second->setOnClickCallback(callback);
-    }
 }
 
 void GameView::setOnUndoClickCallback(const std::function<void()>& callback)
@@ -242,12 +496,50 @@ void GameView::setOnUndoClickCallback(const std::function<void()>& callback)
     _onUndoClickCallback = callback;
 }
 
+void GameView::setOnRedoClickCallback(const std::function<void()>& callback)
+{
+    _onRedoClickCallback = callback;
+}
+
+void GameView::setOnHintClickCallback(const std::function<void()>& callback)
+{
+    _onHintClickCallback = callback;
+}
+
+void GameView::showHint(int cardId)
+{
+    clearHint();
+    
+    CardView* cardView = getCardView(cardId);
+    if (!cardView)
+        return;
+    
+    auto pulse = Sequence::create(ScaleTo::create(0.2f, 1.15f), ScaleTo::create(0.2f, 1.0f), nullptr);
+    auto action = Repeat::create(pulse, 3);
+    action->setTag(kHintActionTag);
+    cardView->runAction(action);
+    _hintCardId = cardId;
+}
+
+void GameView::clearHint()
+{
+    CardView* cardView = getCardView(_hintCardId);
+    if (cardView)
+    {
+        cardView->stopActionByTag(kHintActionTag);
+        cardView->setScale(1.0f);
+    }
+    _hintCardId = -1;
+}
+
 void GameView::playMoveAnimation(int cardId, const cocos2d::Vec2& targetPosition, 
                                 const std::function<void()>& callback)
 {
     CardView* cardView = getCardView(cardId);
     if (cardView)
     {
+        _cardDisplays[cardId].position = targetPosition;
+        updateHitRect(cardId);
         cardView->playMoveAnimation(targetPosition, 0.3f, callback);
     }
 }
@@ -258,6 +550,40 @@ void GameView::playUndoAnimation(int cardId, const cocos2d::Vec2& targetPosition
     CardView* cardView = getCardView(cardId);
     if (cardView)
     {
+        _cardDisplays[cardId].position = targetPosition;
+        updateHitRect(cardId);
         cardView->playMoveAnimation(targetPosition, 0.3f, callback);
     }
 }
+
+void GameView::playDisplacementAnimation(const std::vector<CardDisplacement>& displacements,
+                                         const std::function<void()>& callback)
+{
+    // 所有卡牌动画时长相同，完成回调挂在最后一个有视图的卡牌上
+    CardView* lastView = nullptr;
+    for (const CardDisplacement& move : displacements)
+    {
+        CardView* cardView = getCardView(move.cardId);
+        if (cardView)
+        {
+            lastView = cardView;
+        }
+    }
+    
+    for (const CardDisplacement& move : displacements)
+    {
+        CardView* cardView = getCardView(move.cardId);
+        if (!cardView)
+            continue;
+        
+        cardView->setPosition(move.from);
+        _cardDisplays[move.cardId].position = move.to;
+        updateHitRect(move.cardId);
+        cardView->playMoveAnimation(move.to, 0.3f, cardView == lastView ? callback : nullptr);
+    }
+    
+    if (!lastView && callback)
+    {
+        callback();
+    }
+}
@@ -14,8 +14,11 @@
 
 #include "cocos2d.h"
 #include "CardView.h"
+#include "CardViewPool.h"
+#include "CardHitGrid.h"
 #include "../models/GameModel.h"
-#include <map>
+#include "../models/UndoModel.h"
+#include <vector>
 #include <functional>
 
 /**
@@ -30,6 +33,13 @@
  * - 支持撤销操作的视觉效果
  * - 管理分层背景和区域划分
  * 
+ * 卡牌点击：
+ * - 视图只注册一个触摸监听器，卡牌视图本身不监听触摸
+ * - 卡牌的目标矩形登记在CardHitGrid中，随视图的位置、层级和可见性同步更新，
+ *   触摸时只检查触点所在格子，按节点层级取最上面一张露出的卡牌；
+ *   被压住的游戏区卡牌和手牌堆中非顶部的卡牌不响应，触摸落到下面的卡牌
+ * - 正在移动的卡牌按动画终点响应点击
+ * 
  * 设计模式：
  * - 使用观察者模式响应模型变化
  * - 采用组合模式管理子视图
@@ -38,6 +48,22 @@
 class GameView : public cocos2d::Layer
 {
 public:
+    /**
+     * @brief 一次updateDisplay的开销统计
+     * 
+     * 增量刷新时cardsChecked等于模型中换过区域的卡牌数，与卡牌总数无关
+     */
+    struct DisplayUpdateStats
+    {
+        int cardsChecked;       // 比对过的卡牌数
+        int viewsCreated;       // 新建的卡牌视图数
+        int viewsRemoved;       // 移除的卡牌视图数
+        int viewsUpdated;       // 位置、层级或可见性有变化的卡牌视图数
+        bool fullRebuild;       // 是否为全部重建（首次显示或换了模型）
+        
+        DisplayUpdateStats() : cardsChecked(0), viewsCreated(0), viewsRemoved(0), viewsUpdated(0), fullRebuild(false) {}
+    };
+    
     // ==================== 构造与析构 ====================
     
     /**
@@ -57,16 +83,18 @@ public:
     /**
      * @brief 创建游戏视图实例
      * @param gameModel 游戏数据模型指针（只读）
+     * @param cardViewPool 卡牌视图对象池（不持有，需比视图存活更久），为空时直接创建和销毁卡牌视图
      * @return 成功创建的游戏视图实例，失败返回nullptr
      * 
      * 静态工厂方法，创建并初始化游戏视图
      * 自动调用initWithGameModel进行完整初始化
      */
-    static GameView* create(const GameModel* gameModel);
+    static GameView* create(const GameModel* gameModel, CardViewPool* cardViewPool = nullptr);
     
     /**
      * @brief 初始化游戏视图
      * @param gameModel 游戏数据模型指针（只读）
+     * @param cardViewPool 卡牌视图对象池，可为空
      * @return true表示初始化成功，false表示初始化失败
      * 
      * 完成以下初始化工作：
@@ -76,7 +104,7 @@ public:
      * - 创建撤销按钮
      * - 建立视图与模型的映射关系
      */
-    bool init(const GameModel* gameModel);
+    bool init(const GameModel* gameModel, CardViewPool* cardViewPool = nullptr);
     
     // ==================== 显示更新方法 ====================
     
@@ -84,14 +112,20 @@ public:
      * @brief 更新所有卡牌显示
      * @param gameModel 更新后的游戏数据模型指针（只读）
      * 
-     * 根据模型数据的变化更新视图显示：
-     * - 同步卡牌位置和可见性
-     * - 更新卡牌层级关系
-     * - 刷新撤销按钮状态
-     * - 触发必要的动画效果
+     * 根据模型数据的变化增量更新视图显示：
+     * - 只比对GameModel::getChangedCards中换过区域的卡牌，调用方刷新后负责清空变化记录
+     * - 离开所有区域的卡牌移除视图，新进入区域的卡牌创建视图
+     * - 其余卡牌与上次同步的状态比对，只设置有变化的位置、层级和可见性
+     * - 卡牌正在向模型位置移动时不打断动画
+     * 首次显示或换了模型时全部重建
      */
     void updateDisplay(const GameModel* gameModel);
     
+    /**
+     * @brief 获取最近一次updateDisplay的开销统计
+     */
+    const DisplayUpdateStats& getLastUpdateStats() const { return _lastUpdateStats; }
+    
     /**
      * @brief 播放卡牌匹配动画
      * @param card1 第一张匹配的卡牌模型
@@ -127,6 +161,30 @@ public:
     void playUndoAnimation(int cardId, const cocos2d::Vec2& targetPosition,
                           const std::function<void()>& callback = nullptr);
     
+    /**
+     * @brief 播放批量回退动画
+     * @param displacements 每张卡牌的净位移（UndoManager批量回退的输出）
+     * @param callback 所有动画完成后的回调函数（可选）
+     * 
+     * 在updateDisplay之后调用：卡牌视图已按模型位于终点，先放回起点再同时移动到终点，
+     * 多步回退只播放一组动画
+     */
+    void playDisplacementAnimation(const std::vector<CardDisplacement>& displacements,
+                                   const std::function<void()>& callback = nullptr);
+    
+    /**
+     * @brief 高亮提示的卡牌
+     * @param cardId 推荐点击的卡牌ID
+     * 
+     * 卡牌放大闪烁几次，同一时间只高亮一张；下一次updateDisplay时提示自动消失
+     */
+    void showHint(int cardId);
+    
+    /**
+     * @brief 清除当前提示高亮
+     */
+    void clearHint();
+    
     // ==================== 事件回调设置 ====================
     
     /**
@@ -135,6 +193,7 @@ public:
      * 
      * 注册卡牌点击事件的处理函数，当用户点击卡牌时触发
      * 通常连接到控制器的卡牌选择逻辑
+     * 按下和抬起都落在同一张卡牌上才算一次点击
      */
     void setOnCardClickCallback(const std::function<void(int)>& callback);
     
@@ -147,6 +206,18 @@ public:
      */
     void setOnUndoClickCallback(const std::function<void()>& callback);
     
+    /**
+     * @brief 设置重做按钮点击事件回调函数
+     * @param callback 重做按钮点击回调函数
+     */
+    void setOnRedoClickCallback(const std::function<void()>& callback);
+    
+    /**
+     * @brief 设置提示按钮点击事件回调函数
+     * @param callback 提示按钮点击回调函数
+     */
+    void setOnHintClickCallback(const std::function<void()>& callback);
+    
     // ==================== 卡牌视图管理 ====================
     
     /**
@@ -163,16 +234,23 @@ public:
      * @param cardId 要移除的卡牌唯一标识符
      * 
      * 移除指定ID的卡牌视图，清理相关资源和映射关系
-     * 通常在卡牌匹配消除时调用
+     * 有对象池时视图回收到对象池，否则直接销毁
      */
     void removeCardView(int cardId);
     
+    /**
+     * @brief 移除所有卡牌视图
+     * 
+     * 视图从场景移除前由控制器调用，卡牌视图回收到对象池供下一关复用
+     */
+    void recycleCardViews();
+    
     /**
      * @brief 根据ID获取卡牌视图
      * @param cardId 卡牌唯一标识符
      * @return 对应的卡牌视图指针，找不到时返回nullptr
      * 
-     * 从内部映射表中查找指定ID的卡牌视图
+     * 按卡牌ID直接下标访问，O(1)
      * 用于更新特定卡牌的显示状态
      */
     CardView* getCardView(int cardId) const;
@@ -208,6 +286,20 @@ private:
      */
     void createUndoButton();
     
+    /**
+     * @brief 创建重做按钮
+     * 
+     * 放在撤销按钮下方
+     */
+    void createRedoButton();
+    
+    /**
+     * @brief 创建提示按钮
+     * 
+     * 放在撤销按钮上方
+     */
+    void createHintButton();
+    
     /**
      * @brief 创建游戏区域容器
      * 
@@ -217,25 +309,91 @@ private:
      * - 备牌堆节点（下方右侧）
      */
     void createGameAreas();
+    
+    /**
+     * @brief 移除所有卡牌视图并按模型重新创建
+     */
+    void rebuildCardViews();
+    
+    /**
+     * @brief 按模型同步单张卡牌的视图
+     * @param cardId 卡牌ID
+     * 
+     * 与上次同步的状态比对，只做有变化的节点操作，并计入_lastUpdateStats
+     */
+    void syncCardView(int cardId);
+    
+    /**
+     * @brief 按上次同步的显示状态更新卡牌在点击检测网格中的矩形
+     * @param cardId 卡牌ID
+     * 
+     * 没有视图或不可见的卡牌从网格中移除
+     */
+    void updateHitRect(int cardId);
+    
+    /**
+     * @brief 设置卡牌的触摸事件监听
+     */
+    void setupTouchListener();
+    
+    /**
+     * @brief 处理卡牌触摸事件
+     */
+    bool onTouchBegan(cocos2d::Touch* touch, cocos2d::Event* event);
+    void onTouchEnded(cocos2d::Touch* touch, cocos2d::Event* event);
+    
+    /**
+     * @brief 卡牌能否响应点击
+     * @param cardId 卡牌ID
+     * @return 游戏区卡牌未被压住、手牌堆顶部卡牌或底牌时返回true
+     * 
+     * 直接查询模型：卡牌被移走后，下面的卡牌不换区也会露出
+     */
+    bool isCardTouchable(int cardId) const;
 
 private:
     // ==================== 私有成员变量 ====================
     
     const GameModel* _gameModel;                                // 游戏数据模型（只读引用）
+    CardViewPool* _cardViewPool;                                // 卡牌视图对象池（不持有），可为空
+    
+    /**
+     * 卡牌视图及其上次同步时的显示状态
+     */
+    struct CardDisplay
+    {
+        CardView* view;                 // 卡牌视图，没有视图时为nullptr
+        cocos2d::Vec2 position;         // 视图的目标位置（播放移动动画时为动画终点）
+        int zOrder;                     // 节点层级（同层内按cardId排列），也是点击检测的叠放优先级
+        bool visible;
+        
+        CardDisplay() : view(nullptr), zOrder(0), visible(false) {}
+    };
     
     // 卡牌视图管理
-    std::map<int, CardView*> _cardViews;                        // 卡牌ID到CardView指针的映射表
+    std::vector<CardDisplay> _cardDisplays;                     // 下标即cardId，与卡牌池一一对应
+    DisplayUpdateStats _lastUpdateStats;                        // 最近一次updateDisplay的开销统计
     int _currentTrayCardId;                                     // 当前托盘卡牌ID，用于跟踪托盘状态变化
     
+    // 卡牌点击
+    CardHitGrid _hitGrid;                                       // 卡牌矩形的点击检测网格（_playfieldNode坐标系）
+    cocos2d::EventListenerTouchOneByOne* _cardTouchListener;    // 卡牌触摸监听器（Layer已有_touchListener）
+    int _touchedCardId;                                         // 按下时命中的卡牌ID，-1表示没有
+    
     // UI组件节点
     cocos2d::Node* _playfieldNode;                              // 主游戏区域容器节点
     cocos2d::Node* _stackNode;                                  // 备牌堆容器节点
     cocos2d::Node* _trayNode;                                   // 托盘区域容器节点
     cocos2d::Menu* _undoButton;                                 // 撤销按钮菜单组件
+    cocos2d::Menu* _redoButton;                                 // 重做按钮菜单组件
+    cocos2d::Menu* _hintButton;                                 // 提示按钮菜单组件
+    int _hintCardId;                                            // 当前高亮提示的卡牌ID，-1表示没有
     
     // 事件回调函数
     std::function<void(int)> _onCardClickCallback;              // 卡牌点击事件回调函数
     std::function<void()> _onUndoClickCallback;                 // 撤销按钮点击事件回调函数
+    std::function<void()> _onRedoClickCallback;                 // 重做按钮点击事件回调函数
+    std::function<void()> _onHintClickCallback;                 // 提示按钮点击事件回调函数
     
     // 布局常量定义
     static const cocos2d::Vec2 kStackPosition;                  // 备牌堆的固定位置坐标
@@ -0,0 +1,278 @@
+/**
+ * @file main.cpp
+ * @brief 卡牌图集打包工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把CardResConfig::getCardImagePaths列出的卡牌背景、数字和花色图片打包为一张图集：
+ * res/cards.png + cocos2d SpriteFrameCache格式（format 2）的res/cards.plist，精灵帧名即原图片路径，
+ * CardResConfig加载图集后按原路径查找精灵帧，所有卡牌精灵共用一张纹理
+ * - 按高度降序逐行摆放，不旋转、不裁剪透明边，精灵帧尺寸与原图一致
+ * - 每张图片向外复制1像素边缘，图片之间再留2像素透明间隔，缩放采样时不会串入相邻图片
+ * 只用到cocos2d的Image，不创建窗口
+ *
+ * 用法：CardAtlasPacker [--resources DIR] [--width N]
+ *   默认读取Resources目录，写出Resources/res/cards.png和Resources/res/cards.plist，图集宽1024像素
+ * 退出码：0成功，1写出失败，2输入错误
+ */
+
+#include "configs/models/CardResConfig.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    const int kExtrude = 1;         // 向外复制的边缘像素
+    const int kSpacing = 2;         // 图片之间的透明间隔
+    
+    /**
+     * 待打包的图片，像素为RGBA8888（非预乘）
+     */
+    struct SourceImage
+    {
+        std::string name;           // 精灵帧名（相对Resources的图片路径）
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+        int x;                      // 在图集中的位置（不含复制的边缘）
+        int y;
+    };
+    
+    bool loadImage(const std::string& resources, SourceImage& source)
+    {
+        std::string path = resources + "/" + source.name;
+        Image* image = new Image();
+        bool loaded = image->initWithImageFile(path);
+        Texture2D::PixelFormat format = loaded ? image->getRenderFormat() : Texture2D::PixelFormat::NONE;
+        if (format != Texture2D::PixelFormat::RGBA8888 && format != Texture2D::PixelFormat::RGB888)
+        {
+            std::fprintf(stderr, "%s: cannot load as 8-bit RGB/RGBA image\n", path.c_str());
+            delete image;
+            return false;
+        }
+        
+        source.width = image->getWidth();
+        source.height = image->getHeight();
+        source.pixels.resize(static_cast<size_t>(source.width) * source.height * 4);
+        
+        const uint8_t* data = image->getData();
+        if (format == Texture2D::PixelFormat::RGBA8888)
+        {
+            std::memcpy(source.pixels.data(), data, source.pixels.size());
+        }
+        else
+        {
+            for (size_t i = 0; i < static_cast<size_t>(source.width) * source.height; ++i)
+            {
+                std::memcpy(&source.pixels[i * 4], data + i * 3, 3);
+                source.pixels[i * 4 + 3] = 0xFF;
+            }
+        }
+        delete image;
+        return true;
+    }
+    
+    /**
+     * 逐行摆放，一行放不下时另起一行，行高取本行第一张（最高的）图片
+     * @return 图集高度；有图片比图集还宽时返回-1
+     */
+    int layoutImages(std::vector<SourceImage*>& images, int atlasWidth)
+    {
+        std::sort(images.begin(), images.end(), [](const SourceImage* a, const SourceImage* b) {
+            return a->height != b->height ? a->height > b->height : a->name < b->name;
+        });
+        
+        int x = 0;
+        int y = 0;
+        int rowHeight = 0;
+        for (SourceImage* image : images)
+        {
+            int cellWidth = image->width + kExtrude * 2;
+            int cellHeight = image->height + kExtrude * 2;
+            if (cellWidth > atlasWidth)
+                return -1;
+            
+            if (x + cellWidth > atlasWidth)
+            {
+                x = 0;
+                y += rowHeight + kSpacing;
+                rowHeight = 0;
+            }
+            image->x = x + kExtrude;
+            image->y = y + kExtrude;
+            x += cellWidth + kSpacing;
+            rowHeight = std::max(rowHeight, cellHeight);
+        }
+        return y + rowHeight;
+    }
+    
+    /**
+     * 把图片复制到图集，并把四周的边缘像素向外复制kExtrude像素
+     */
+    void blitImage(const SourceImage& image, std::vector<uint8_t>& atlas, int atlasWidth)
+    {
+        for (int row = -kExtrude; row < image.height + kExtrude; ++row)
+        {
+            int sourceRow = std::min(std::max(row, 0), image.height - 1);
+            for (int column = -kExtrude; column < image.width + kExtrude; ++column)
+            {
+                int sourceColumn = std::min(std::max(column, 0), image.width - 1);
+                const uint8_t* from = &image.pixels[(static_cast<size_t>(sourceRow) * image.width + sourceColumn) * 4];
+                uint8_t* to = &atlas[(static_cast<size_t>(image.y + row) * atlasWidth + image.x + column) * 4];
+                std::memcpy(to, from, 4);
+            }
+        }
+    }
+    
+    std::string buildPlist(const std::vector<SourceImage>& images, const std::string& textureName, int width, int height)
+    {
+        std::string plist =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+            "<plist version=\"1.0\">\n"
+            "<dict>\n"
+            "    <key>frames</key>\n"
+            "    <dict>\n";
+        
+        char line[512];
+        for (const SourceImage& image : images)
+        {
+            plist += "        <key>" + image.name + "</key>\n        <dict>\n";
+            std::snprintf(line, sizeof(line),
+                          "            <key>frame</key>\n"
+                          "            <string>{{%d,%d},{%d,%d}}</string>\n"
+                          "            <key>offset</key>\n"
+                          "            <string>{0,0}</string>\n"
+                          "            <key>rotated</key>\n"
+                          "            <false/>\n"
+                          "            <key>sourceColorRect</key>\n"
+                          "            <string>{{0,0},{%d,%d}}</string>\n"
+                          "            <key>sourceSize</key>\n"
+                          "            <string>{%d,%d}</string>\n",
+                          image.x, image.y, image.width, image.height,
+                          image.width, image.height, image.width, image.height);
+            plist += line;
+            plist += "        </dict>\n";
+        }
+        
+        std::snprintf(line, sizeof(line), "{%d,%d}", width, height);
+        plist += "    </dict>\n"
+                 "    <key>metadata</key>\n"
+                 "    <dict>\n"
+                 "        <key>format</key>\n"
+                 "        <integer>2</integer>\n"
+                 "        <key>realTextureFileName</key>\n"
+                 "        <string>" + textureName + "</string>\n"
+                 "        <key>size</key>\n"
+                 "        <string>" + std::string(line) + "</string>\n"
+                 "        <key>textureFileName</key>\n"
+                 "        <string>" + textureName + "</string>\n"
+                 "    </dict>\n"
+                 "</dict>\n"
+                 "</plist>\n";
+        return plist;
+    }
+    
+    bool writeFile(const std::string& path, const std::string& content)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        bool written = file && std::fwrite(content.data(), 1, content.size(), file) == content.size();
+        if (file)
+        {
+            written = std::fclose(file) == 0 && written;
+        }
+        return written;
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: CardAtlasPacker [--resources DIR] [--width N]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string resources = "Resources";
+    int atlasWidth = 1024;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--resources") == 0 && hasValue)
+        {
+            resources = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--width") == 0 && hasValue)
+        {
+            atlasWidth = std::atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+    
+    if (atlasWidth <= 0)
+    {
+        printUsage();
+        return 2;
+    }
+    
+    // 保留PNG原始的非预乘像素，写回图集后由引擎加载时再统一预乘
+    Image::setPNGPremultipliedAlphaEnabled(false);
+    
+    std::vector<SourceImage> images;
+    for (const std::string& name : CardResConfig::getCardImagePaths())
+    {
+        SourceImage image;
+        image.name = name;
+        if (!loadImage(resources, image))
+            return 2;
+        images.push_back(std::move(image));
+    }
+    
+    std::vector<SourceImage*> order;
+    for (SourceImage& image : images)
+    {
+        order.push_back(&image);
+    }
+    int atlasHeight = layoutImages(order, atlasWidth);
+    if (atlasHeight < 0)
+    {
+        std::fprintf(stderr, "an image is wider than the atlas (%d px)\n", atlasWidth);
+        return 2;
+    }
+    
+    std::vector<uint8_t> atlas(static_cast<size_t>(atlasWidth) * atlasHeight * 4, 0);
+    size_t imagePixels = 0;
+    for (const SourceImage& image : images)
+    {
+        blitImage(image, atlas, atlasWidth);
+        imagePixels += static_cast<size_t>(image.width) * image.height;
+    }
+    
+    // 纹理文件名相对plist所在目录
+    std::string atlasPath = resources + "/" + CardResConfig::getCardAtlasPath();
+    std::string texturePath = atlasPath.substr(0, atlasPath.size() - 6) + ".png";
+    std::string textureName = texturePath.substr(texturePath.find_last_of('/') + 1);
+    
+    Image output;
+    bool written = output.initWithRawData(atlas.data(), atlas.size(), atlasWidth, atlasHeight, 8, false)
+        && output.saveToFile(texturePath, false);
+    if (!written || !writeFile(atlasPath, buildPlist(images, textureName, atlasWidth, atlasHeight)))
+    {
+        std::fprintf(stderr, "%s: cannot write atlas\n", atlasPath.c_str());
+        return 1;
+    }
+    
+    std::printf("%s: %zu frames, %dx%d, %.1f%% filled\n", atlasPath.c_str(), images.size(), atlasWidth, atlasHeight,
+                100.0 * imagePixels / (static_cast<double>(atlasWidth) * atlasHeight));
+    return 0;
+}
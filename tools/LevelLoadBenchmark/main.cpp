@@ -0,0 +1,231 @@
+/**
+ * @file main.cpp
+ * @brief 关卡JSON加载基准工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 在内存中生成一批随机关卡JSON（格式与levels/level_<id>.json相同，另带一个会被跳过的未知字段），
+ * 用LevelConfigLoader逐个加载整批关卡，输出每轮的总耗时、每个关卡的平均耗时和吞吐量，
+ * 并校验加载出的卡牌与生成时一致
+ * - insitu：在整批关卡的可写副本上原地解析（每轮开始前恢复副本，恢复不计时）
+ * - string：loadFromJsonString，包含复制输入字符串的开销
+ * 只用到cocos2d的Vec2与日志，不创建窗口
+ *
+ * 用法：LevelLoadBenchmark [--levels N] [--playfield N] [--stack N] [--passes N] [--seed N]
+ *   默认10000个关卡，每个关卡20张游戏区卡牌、10张手牌堆卡牌
+ */
+
+#include "configs/loaders/LevelConfigLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        int levels = 10000;
+        int playfieldCards = 20;
+        int stackCards = 10;
+        int passes = 5;
+        unsigned seed = 1;
+    };
+    
+    /**
+     * 关卡语料：所有关卡的JSON首尾相接存放在一块缓冲区中，各自以'\0'结尾
+     */
+    struct LevelCorpus
+    {
+        std::vector<char> text;
+        std::vector<size_t> offsets;            // 每个关卡的起始偏移
+        std::vector<uint64_t> checksums;        // 生成时的卡牌校验和
+    };
+    
+    uint64_t mixCard(uint64_t checksum, CardCode code, float x, float y)
+    {
+        return checksum * 1099511628211ULL + code.bits * 31 + static_cast<uint64_t>(x) * 7 + static_cast<uint64_t>(y);
+    }
+    
+    uint64_t checksumLevel(const LevelConfig& level)
+    {
+        uint64_t checksum = 0;
+        for (const auto& card : level.getPlayfieldCards())
+        {
+            checksum = mixCard(checksum, card.card, card.position.x, card.position.y);
+        }
+        checksum = mixCard(checksum, CardCode(), -1.0f, -1.0f);
+        for (const auto& card : level.getStackCards())
+        {
+            checksum = mixCard(checksum, card.card, card.position.x, card.position.y);
+        }
+        return checksum;
+    }
+    
+    /**
+     * 生成随机关卡语料，坐标取整数，保证解析结果与生成值完全一致
+     */
+    LevelCorpus createCorpus(const BenchmarkOptions& options)
+    {
+        std::mt19937 rng(options.seed);
+        std::uniform_int_distribution<int> face(CFT_ACE, CFT_KING);
+        std::uniform_int_distribution<int> suit(CST_CLUBS, CST_SPADES);
+        std::uniform_int_distribution<int> coordinate(0, 1500);
+        
+        LevelCorpus corpus;
+        std::string json;
+        char line[128];
+        for (int level = 0; level < options.levels; ++level)
+        {
+            uint64_t checksum = 0;
+            json = "{\n    \"Name\": \"generated\",\n    \"Playfield\": [\n";
+            for (int i = 0; i < options.playfieldCards; ++i)
+            {
+                int cardFace = face(rng);
+                int cardSuit = suit(rng);
+                int x = coordinate(rng);
+                int y = coordinate(rng);
+                std::snprintf(line, sizeof(line), "        { \"CardFace\": %d, \"CardSuit\": %d, \"Position\": { \"x\": %d, \"y\": %d } }%s\n",
+                              cardFace, cardSuit, x, y, i + 1 < options.playfieldCards ? "," : "");
+                json += line;
+                checksum = mixCard(checksum, CardCode(static_cast<CardFaceType>(cardFace), static_cast<CardSuitType>(cardSuit)),
+                                   static_cast<float>(x), static_cast<float>(y));
+            }
+            json += "    ],\n    \"Stack\": [\n";
+            checksum = mixCard(checksum, CardCode(), -1.0f, -1.0f);
+            for (int i = 0; i < options.stackCards; ++i)
+            {
+                int cardFace = face(rng);
+                int cardSuit = suit(rng);
+                std::snprintf(line, sizeof(line), "        { \"CardFace\": %d, \"CardSuit\": %d }%s\n",
+                              cardFace, cardSuit, i + 1 < options.stackCards ? "," : "");
+                json += line;
+                checksum = mixCard(checksum, CardCode(static_cast<CardFaceType>(cardFace), static_cast<CardSuitType>(cardSuit)), 0.0f, 0.0f);
+            }
+            json += "    ]\n}\n";
+            
+            corpus.offsets.push_back(corpus.text.size());
+            corpus.text.insert(corpus.text.end(), json.begin(), json.end());
+            corpus.text.push_back('\0');
+            corpus.checksums.push_back(checksum);
+        }
+        return corpus;
+    }
+    
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * 多轮加载整批关卡，输出最快一轮的耗时
+     * @param insitu true为原地解析，false为loadFromJsonString
+     * @return 加载失败或卡牌与生成时不一致时返回false
+     */
+    bool runPasses(const BenchmarkOptions& options, const LevelCorpus& corpus, bool insitu)
+    {
+        std::vector<char> buffer(corpus.text.size());
+        std::vector<std::string> strings;
+        if (!insitu)
+        {
+            for (size_t offset : corpus.offsets)
+            {
+                strings.push_back(&corpus.text[offset]);
+            }
+        }
+        
+        double bestMs = 0.0;
+        bool consistent = true;
+        for (int pass = 0; pass < options.passes; ++pass)
+        {
+            if (insitu)
+            {
+                std::memcpy(buffer.data(), corpus.text.data(), buffer.size());
+            }
+            
+            std::vector<std::unique_ptr<LevelConfig>> levels;
+            levels.reserve(corpus.offsets.size());
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < corpus.offsets.size(); ++i)
+            {
+                levels.emplace_back(insitu ? LevelConfigLoader::loadFromJsonInsitu(&buffer[corpus.offsets[i]])
+                                           : LevelConfigLoader::loadFromJsonString(strings[i]));
+            }
+            double ms = elapsedMs(start);
+            bestMs = pass == 0 ? ms : std::min(bestMs, ms);
+            
+            for (size_t i = 0; i < levels.size(); ++i)
+            {
+                consistent = consistent && levels[i] && checksumLevel(*levels[i]) == corpus.checksums[i];
+            }
+        }
+        
+        double megabytes = corpus.text.size() / (1024.0 * 1024.0);
+        std::printf("  %-7s %9.2f ms   %7.2f us/level   %7.1f MB/s   %s\n",
+                    insitu ? "insitu" : "string", bestMs, bestMs * 1000.0 / corpus.offsets.size(),
+                    megabytes / (bestMs / 1000.0), consistent ? "ok" : "MISMATCH");
+        return consistent;
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: LevelLoadBenchmark [--levels N] [--playfield N] [--stack N] [--passes N] [--seed N]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--levels") == 0 && hasValue)
+        {
+            options.levels = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--playfield") == 0 && hasValue)
+        {
+            options.playfieldCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--stack") == 0 && hasValue)
+        {
+            options.stackCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--passes") == 0 && hasValue)
+        {
+            options.passes = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+    
+    if (options.levels < 1 || options.passes < 1 || options.playfieldCards < 0 || options.stackCards < 0)
+    {
+        printUsage();
+        return 2;
+    }
+    
+    LevelCorpus corpus = createCorpus(options);
+    std::printf("%d levels (%d + %d cards), %.1f MB of JSON, best of %d passes\n",
+                options.levels, options.playfieldCards, options.stackCards,
+                corpus.text.size() / (1024.0 * 1024.0), options.passes);
+    
+    bool consistent = runPasses(options, corpus, true);
+    consistent = runPasses(options, corpus, false) && consistent;
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file main.cpp
+ * @brief 关卡包编译工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 把一批关卡JSON（用LevelConfigLoader解析，格式同Resources/levels/level_<id>.json）编译为一个关卡包：
+ * 文件头 + 按关卡ID排列的偏移索引 + 定长卡牌记录（格式见Classes/utils/LevelPackFormat.h）。
+ * 关卡ID取自文件名中的level_<id>，编号之间的空缺在索引中记为缺失。
+ * 写出后用LevelPackReader重新打开，逐个关卡与JSON解析结果比对，并输出打开和随机访问的耗时
+ * 只用到cocos2d的Vec2、FileUtils与日志，不创建窗口
+ *
+ * 用法：LevelPackCompiler -o levels.pack level_1.json [level_2.json ...]
+ * 退出码：0成功，1写出或校验失败，2输入错误
+ */
+
+#include "configs/loaders/LevelConfigLoader.h"
+#include "configs/loaders/LevelPackReader.h"
+#include "utils/LevelPackFormat.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+using namespace LevelPackFormat;
+
+namespace
+{
+    struct SourceLevel
+    {
+        int levelId;
+        std::string path;
+        std::unique_ptr<LevelConfig> config;
+    };
+    
+    /**
+     * 从文件名中取出关卡ID（level_<id>.json）
+     * @return 文件名不符合时返回false
+     */
+    bool parseLevelId(const std::string& path, int& levelId)
+    {
+        size_t slash = path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        char* end = nullptr;
+        if (name.compare(0, 6, "level_") != 0)
+            return false;
+        
+        long value = std::strtol(name.c_str() + 6, &end, 10);
+        if (end == name.c_str() + 6 || std::strcmp(end, ".json") != 0 || value < 0 || value > 0x7FFFFFFF)
+            return false;
+        
+        levelId = static_cast<int>(value);
+        return true;
+    }
+    
+    bool loadSource(SourceLevel& level)
+    {
+        std::ifstream file(level.path, std::ios::binary);
+        if (!file)
+        {
+            std::fprintf(stderr, "%s: cannot open file\n", level.path.c_str());
+            return false;
+        }
+        
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string json = buffer.str();
+        level.config.reset(LevelConfigLoader::loadFromJsonInsitu(&json[0]));
+        if (!level.config)
+        {
+            std::fprintf(stderr, "%s: invalid level JSON\n", level.path.c_str());
+            return false;
+        }
+        
+        if (level.config->getPlayfieldCards().size() > 0xFFFF || level.config->getStackCards().size() > 0xFFFF)
+        {
+            std::fprintf(stderr, "%s: too many cards\n", level.path.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+    void appendCards(const std::vector<LevelConfig::CardConfig>& cards, std::vector<uint8_t>& out)
+    {
+        for (const auto& card : cards)
+        {
+            CardRecord record;
+            std::memset(&record, 0, sizeof(record));
+            record.x = card.position.x;
+            record.y = card.position.y;
+            record.code = card.card.bits;
+            
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+            out.insert(out.end(), bytes, bytes + sizeof(record));
+        }
+    }
+    
+    /**
+     * 生成关卡包
+     * @param levels 按关卡ID升序排列、ID不重复的关卡
+     * @return 超过4GB时返回false
+     */
+    bool buildPack(const std::vector<SourceLevel>& levels, std::vector<uint8_t>& out)
+    {
+        int firstLevelId = levels.front().levelId;
+        uint32_t levelCount = static_cast<uint32_t>(levels.back().levelId - firstLevelId + 1);
+        
+        std::vector<LevelEntry> entries(levelCount);
+        std::memset(entries.data(), 0, entries.size() * sizeof(LevelEntry));
+        
+        out.assign(sizeof(FileHeader) + entries.size() * sizeof(LevelEntry), 0);
+        for (const SourceLevel& level : levels)
+        {
+            if (out.size() > 0xFFFFFFFFu)
+                return false;
+            
+            LevelEntry& entry = entries[level.levelId - firstLevelId];
+            entry.offset = static_cast<uint32_t>(out.size());
+            entry.playfieldCount = static_cast<uint16_t>(level.config->getPlayfieldCards().size());
+            entry.stackCount = static_cast<uint16_t>(level.config->getStackCards().size());
+            appendCards(level.config->getPlayfieldCards(), out);
+            appendCards(level.config->getStackCards(), out);
+        }
+        if (out.size() > 0xFFFFFFFFu)
+            return false;
+        
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.headerSize = sizeof(FileHeader);
+        header.totalSize = static_cast<uint32_t>(out.size());
+        header.firstLevelId = firstLevelId;
+        header.levelCount = levelCount;
+        header.entrySize = sizeof(LevelEntry);
+        header.cardSize = sizeof(CardRecord);
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(FileHeader), entries.data(), entries.size() * sizeof(LevelEntry));
+        return true;
+    }
+    
+    bool sameCards(const std::vector<LevelConfig::CardConfig>& a, const std::vector<LevelConfig::CardConfig>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].card.bits != b[i].card.bits || a[i].position != b[i].position)
+                return false;
+        }
+        return true;
+    }
+    
+    double elapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * 重新打开关卡包，校验每个关卡并计时
+     */
+    bool verifyPack(const std::string& path, const std::vector<SourceLevel>& levels)
+    {
+        auto start = std::chrono::steady_clock::now();
+        LevelPackReader reader;
+        if (!reader.open(path))
+        {
+            std::fprintf(stderr, "%s: cannot reopen level pack\n", path.c_str());
+            return false;
+        }
+        double openUs = elapsedUs(start);
+        
+        for (const SourceLevel& level : levels)
+        {
+            std::unique_ptr<LevelConfig> loaded(reader.createLevelConfig(level.levelId));
+            if (!loaded || !sameCards(loaded->getPlayfieldCards(), level.config->getPlayfieldCards())
+                || !sameCards(loaded->getStackCards(), level.config->getStackCards()))
+            {
+                std::fprintf(stderr, "%s: level %d does not match its JSON\n", path.c_str(), level.levelId);
+                return false;
+            }
+        }
+        
+        // 随机顺序访问全部关卡，模拟切换关卡
+        std::vector<int> order;
+        for (const SourceLevel& level : levels)
+        {
+            order.push_back(level.levelId);
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(1));
+        
+        start = std::chrono::steady_clock::now();
+        size_t cards = 0;
+        for (int levelId : order)
+        {
+            std::unique_ptr<LevelConfig> loaded(reader.createLevelConfig(levelId));
+            cards += loaded->getPlayfieldCards().size() + loaded->getStackCards().size();
+        }
+        double accessUs = elapsedUs(start);
+        
+        std::printf("verified: open %.1f us, random access %.2f us/level (%zu cards)\n",
+                    openUs, accessUs / order.size(), cards);
+        return true;
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: LevelPackCompiler -o levels.pack level_1.json [level_2.json ...]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string outputPath;
+    std::vector<SourceLevel> levels;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+            continue;
+        }
+        
+        SourceLevel level;
+        level.path = argv[i];
+        if (!parseLevelId(level.path, level.levelId))
+        {
+            std::fprintf(stderr, "%s: file name must be level_<id>.json\n", argv[i]);
+            return 2;
+        }
+        levels.push_back(std::move(level));
+    }
+    
+    if (outputPath.empty() || levels.empty())
+    {
+        printUsage();
+        return 2;
+    }
+    
+    std::sort(levels.begin(), levels.end(), [](const SourceLevel& a, const SourceLevel& b) { return a.levelId < b.levelId; });
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        if (i > 0 && levels[i].levelId == levels[i - 1].levelId)
+        {
+            std::fprintf(stderr, "%s: duplicate level %d\n", levels[i].path.c_str(), levels[i].levelId);
+            return 2;
+        }
+        if (!loadSource(levels[i]))
+            return 2;
+    }
+    
+    std::vector<uint8_t> pack;
+    if (!buildPack(levels, pack))
+    {
+        std::fprintf(stderr, "level pack exceeds 4 GB\n");
+        return 1;
+    }
+    
+    FILE* file = std::fopen(outputPath.c_str(), "wb");
+    bool written = file && std::fwrite(pack.data(), 1, pack.size(), file) == pack.size();
+    if (file)
+    {
+        written = std::fclose(file) == 0 && written;
+    }
+    if (!written)
+    {
+        std::fprintf(stderr, "%s: cannot write file\n", outputPath.c_str());
+        return 1;
+    }
+    
+    std::printf("%s: %zu levels (ids %d-%d), %.1f KB\n", outputPath.c_str(), levels.size(),
+                levels.front().levelId, levels.back().levelId, pack.size() / 1024.0);
+    return verifyPack(outputPath, levels) ? 0 : 1;
+}
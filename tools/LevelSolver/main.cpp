@@ -0,0 +1,283 @@
+/**
+ * @file main.cpp
+ * @brief 关卡求解命令行工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 读取关卡JSON文件，判断能否通关并输出最短通关走法
+ * 只依赖求解器与cocos2d自带的rapidjson头文件，不链接cocos2d
+ *
+ * 用法：LevelSolver [--max-nodes N] [--tt-bits N] [--threads N | --bench] level.json [level2.json ...]
+ *   --threads N  使用N个线程的并行求解器（0为硬件并发数），只判断可解性，给出的走法不保证最短
+ *   --bench      依次用1、2、4……个线程求解每个关卡，输出节点数、每秒节点数与加速比
+ *
+ * 关卡格式：
+ * {
+ *     "Playfield": [ { "CardFace": 12, "CardSuit": 0, "Position": { "x": 250, "y": 1000 } }, ... ],
+ *     "Stack":     [ { "CardFace": 2, "CardSuit": 0 }, ... ]
+ * }
+ */
+
+#include "services/LevelSolver.h"
+#include "services/ParallelLevelSolver.h"
+#include "json/document.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    /**
+     * 读取卡牌编码，点数或花色越界时返回false
+     */
+    bool parseCardCode(const rapidjson::Value& value, CardCode& code)
+    {
+        if (!value.IsObject() || !value.HasMember("CardFace") || !value.HasMember("CardSuit"))
+            return false;
+        
+        int face = value["CardFace"].GetInt();
+        int suit = value["CardSuit"].GetInt();
+        if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES || suit < CST_CLUBS || suit >= CST_NUM_CARD_SUIT_TYPES)
+            return false;
+        
+        code = CardCode(static_cast<CardFaceType>(face), static_cast<CardSuitType>(suit));
+        return true;
+    }
+    
+    /**
+     * 读取关卡文件
+     */
+    bool loadLevel(const char* path, SolverLevel& level)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::fprintf(stderr, "%s: cannot open file\n", path);
+            return false;
+        }
+        
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string json = buffer.str();
+        
+        rapidjson::Document doc;
+        doc.Parse<0>(json.c_str());
+        if (doc.HasParseError() || !doc.IsObject())
+        {
+            std::fprintf(stderr, "%s: invalid JSON\n", path);
+            return false;
+        }
+        
+        if (doc.HasMember("Playfield") && doc["Playfield"].IsArray())
+        {
+            const rapidjson::Value& cards = doc["Playfield"];
+            for (rapidjson::SizeType i = 0; i < cards.Size(); ++i)
+            {
+                SolverLevel::Card card;
+                if (!parseCardCode(cards[i], card.code) || !cards[i].HasMember("Position"))
+                {
+                    std::fprintf(stderr, "%s: invalid playfield card %u\n", path, i);
+                    return false;
+                }
+                
+                const rapidjson::Value& position = cards[i]["Position"];
+                card.x = static_cast<float>(position["x"].GetDouble());
+                card.y = static_cast<float>(position["y"].GetDouble());
+                level.playfield.push_back(card);
+            }
+        }
+        
+        if (doc.HasMember("Stack") && doc["Stack"].IsArray())
+        {
+            const rapidjson::Value& cards = doc["Stack"];
+            for (rapidjson::SizeType i = 0; i < cards.Size(); ++i)
+            {
+                CardCode code;
+                if (!parseCardCode(cards[i], code))
+                {
+                    std::fprintf(stderr, "%s: invalid stack card %u\n", path, i);
+                    return false;
+                }
+                level.stack.push_back(code);
+            }
+        }
+        
+        return true;
+    }
+    
+    /**
+     * 卡牌的简短文字表示，如 "QC"、"10H"
+     */
+    std::string cardName(CardCode code)
+    {
+        static const char* const kFaces[] = { "?", "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "?", "?" };
+        static const char kSuits[] = { '?', 'C', 'D', 'H', 'S' };
+        
+        int suit = code.bits >> 4;
+        return std::string(kFaces[code.getFaceCode()]) + (suit < 5 ? kSuits[suit] : '?');
+    }
+    
+    /**
+     * 输出通关走法
+     */
+    void printLine(const GameState& initial, const std::vector<GameMove>& line)
+    {
+        GameState state = initial;
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            GameMove move = line[i];
+            if (move.type == GMT_MATCH)
+            {
+                std::printf("  %3u. match #%d %s\n", static_cast<unsigned>(i + 1), move.bit,
+                            cardName(state.getPlayfieldCode(move.bit)).c_str());
+            }
+            else
+            {
+                std::printf("  %3u. draw       %s\n", static_cast<unsigned>(i + 1),
+                            cardName(state.getStackCode(state.getStackSize() - 1)).c_str());
+            }
+            state.applyMove(move);
+        }
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: LevelSolver [--max-nodes N] [--tt-bits N] [--threads N | --bench] level.json [level2.json ...]\n");
+    }
+    
+    /**
+     * 用不同线程数求解同一关卡，输出扩展速度与加速比
+     */
+    void runBenchmark(const char* path, const GameState& state, int ttBits, uint64_t maxNodes)
+    {
+        int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> threadCounts;
+        for (int count = 1; count < maxThreads; count *= 2)
+        {
+            threadCounts.push_back(count);
+        }
+        threadCounts.push_back(maxThreads);
+        
+        std::printf("%s:\n", path);
+        double baseMs = 0.0;
+        for (int threads : threadCounts)
+        {
+            ParallelLevelSolver solver(threads, ttBits);
+            auto start = std::chrono::steady_clock::now();
+            SolverResult result = solver.solve(state, maxNodes);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (threads == 1)
+            {
+                baseMs = ms;
+            }
+            
+            const char* verdict = !result.complete ? "unknown"
+                : (result.solvable ? "solvable" : "unsolvable");
+            std::printf("  %2d threads: %-10s %10llu nodes %10.2f ms %8.2f Mnodes/s  speedup %.2fx\n",
+                        threads, verdict, static_cast<unsigned long long>(result.nodes), ms,
+                        ms > 0.0 ? result.nodes / ms / 1000.0 : 0.0, ms > 0.0 ? baseMs / ms : 0.0);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t maxNodes = 0;
+    int ttBits = 20;
+    int threads = -1;
+    bool bench = false;
+    std::vector<const char*> files;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--max-nodes") == 0 && i + 1 < argc)
+        {
+            maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--tt-bits") == 0 && i + 1 < argc)
+        {
+            ttBits = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--bench") == 0)
+        {
+            bench = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            printUsage();
+            return 2;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+    
+    if (files.empty())
+    {
+        printUsage();
+        return 2;
+    }
+    
+    LevelSolver solver(ttBits);
+    std::unique_ptr<ParallelLevelSolver> parallelSolver;
+    if (threads >= 0 && !bench)
+    {
+        parallelSolver.reset(new ParallelLevelSolver(threads, ttBits));
+    }
+    int exitCode = 0;
+    
+    for (const char* path : files)
+    {
+        SolverLevel level;
+        GameState state;
+        if (!loadLevel(path, level))
+        {
+            exitCode = 2;
+            continue;
+        }
+        if (!LevelSolver::buildState(level, state))
+        {
+            std::fprintf(stderr, "%s: more than %d playfield or stack cards\n", path, GameState::kMaxPlayfieldCards);
+            exitCode = 2;
+            continue;
+        }
+        
+        if (bench)
+        {
+            runBenchmark(path, state, ttBits, maxNodes);
+            continue;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        SolverResult result = parallelSolver ? parallelSolver->solve(state, maxNodes) : solver.solve(state, maxNodes);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        const char* verdict = !result.complete ? "unknown (node limit reached)"
+            : (result.solvable ? "solvable" : "unsolvable");
+        std::printf("%s: %s, %u moves, %llu nodes, %.2f ms\n", path, verdict,
+                    static_cast<unsigned>(result.line.size()), static_cast<unsigned long long>(result.nodes), ms);
+        
+        if (result.solvable)
+        {
+            printLine(state, result.line);
+        }
+        else if (exitCode == 0)
+        {
+            exitCode = 1;
+        }
+    }
+    
+    return exitCode;
+}
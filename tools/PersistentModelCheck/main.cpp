@@ -0,0 +1,248 @@
+/**
+ * @file main.cpp
+ * @brief 写时复制局面一致性检查工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 生成随机关卡，在GameModel和PersistentGameModel上同步走随机的合法走法，每一步比较两者的
+ * 哈希、得分、底牌、手牌堆高度、游戏区卡牌数以及每张卡牌的区域与翻开状态；
+ * 走牌过程中保存分叉，随机回到某个分叉（applyTo写回GameModel）继续走出新分支，
+ * 最后检查所有分叉没有被后续走法改动，并且写回后与保存时一致
+ * 只用到cocos2d的Vec2与日志，不创建窗口
+ *
+ * 用法：PersistentModelCheck [--playfield N --stack N] [--games N] [--steps N] [--seed N]
+ *   不指定卡牌数时依次检查普通关卡（20+10张）和1000张卡牌的压力关卡（700+300张）
+ */
+
+#include "models/PersistentGameModel.h"
+#include "services/GameModelFromLevelGenerator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    const int kMatchPoints = 10;
+    const size_t kMaxForks = 64;
+    
+    struct CheckOptions
+    {
+        int playfieldCards = -1;
+        int stackCards = -1;
+        int games = 50;
+        int steps = 400;
+        unsigned seed = 1;
+    };
+    
+    /**
+     * 保存的分叉及保存时的哈希、得分
+     */
+    struct SavedFork
+    {
+        PersistentGameModel model;
+        uint64_t zobristHash;
+        int score;
+    };
+    
+    /**
+     * 生成随机关卡：卡牌分布范围随卡牌数增大，保持稀疏的覆盖关系
+     */
+    LevelConfig createRandomLevel(int playfieldCards, int stackCards, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> face(CFT_ACE, CFT_KING);
+        std::uniform_int_distribution<int> suit(CST_CLUBS, CST_SPADES);
+        std::uniform_real_distribution<float> coordinate(0.0f, 300.0f * std::sqrt(static_cast<float>(playfieldCards) + 1.0f));
+        
+        std::vector<LevelConfig::CardConfig> playfield;
+        for (int i = 0; i < playfieldCards; ++i)
+        {
+            playfield.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)),
+                                                        Vec2(coordinate(rng), coordinate(rng))));
+        }
+        
+        std::vector<LevelConfig::CardConfig> stack;
+        for (int i = 0; i < stackCards; ++i)
+        {
+            stack.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)), Vec2::ZERO));
+        }
+        
+        LevelConfig level;
+        level.setPlayfieldCards(playfield);
+        level.setStackCards(stack);
+        return level;
+    }
+    
+    /**
+     * 两个局面是否一致
+     */
+    bool sameState(const GameModel& gameModel, const PersistentGameModel& model)
+    {
+        if (gameModel.getZobristHash() != model.getZobristHash() || gameModel.getScore() != model.getScore()
+            || gameModel.getTrayCardId() != model.getTrayCardId() || gameModel.getStackCards().size() != model.getStackSize()
+            || gameModel.getPlayfieldCards().size() != model.getPlayfieldCount() || gameModel.getCardCount() != model.getCardCount())
+            return false;
+        
+        for (int cardId = 0; cardId < static_cast<int>(gameModel.getCardCount()); ++cardId)
+        {
+            if (gameModel.getCardZone(cardId) != model.getCardZone(cardId)
+                || gameModel.isCardExposed(cardId) != model.isCardExposed(cardId))
+                return false;
+        }
+        return true;
+    }
+    
+    /**
+     * 在两个局面上同步走一步随机的合法走法（GameModel一侧与GameController相同）
+     * PersistentGameModel拒绝走法时局面不变，由调用方的比较发现不一致
+     * @return 没有合法走法时返回false
+     */
+    bool playRandomMove(GameModel& gameModel, PersistentGameModel& model, std::mt19937& rng)
+    {
+        GameMoveList moves;
+        gameModel.generateLegalMoves(moves);
+        if (moves.count == 0)
+            return false;
+        
+        const GameMove& move = moves.moves[rng() % moves.count];
+        int cardId;
+        if (move.type == GMT_MATCH)
+        {
+            cardId = move.bit;
+            model.matchCard(cardId, kMatchPoints);
+            gameModel.removePlayfieldCard(cardId);
+            gameModel.addScore(kMatchPoints);
+        }
+        else
+        {
+            cardId = gameModel.getTopStackCard()->getCardId();
+            model.drawStackCard();
+            gameModel.popStackCard();
+        }
+        gameModel.getCard(cardId)->setPosition(gameModel.getTrayPosition());
+        gameModel.setTrayCard(cardId);
+        return true;
+    }
+    
+    /**
+     * 检查一种关卡规模
+     * @return 出现不一致时返回false
+     */
+    bool runLevel(const CheckOptions& options, int playfieldCards, int stackCards)
+    {
+        std::mt19937 rng(options.seed);
+        int moves = 0;
+        int branches = 0;
+        bool consistent = true;
+        for (int game = 0; game < options.games && consistent; ++game)
+        {
+            LevelConfig level = createRandomLevel(playfieldCards, stackCards, rng);
+            std::unique_ptr<GameModel> gameModel(GameModelFromLevelGenerator::generateGameModel(level));
+            PersistentGameModel model = PersistentGameModel::fromGameModel(*gameModel);
+            
+            std::vector<SavedFork> forks;
+            forks.push_back({ model.fork(), model.getZobristHash(), model.getScore() });
+            for (int step = 0; step < options.steps && consistent; ++step)
+            {
+                // 偶尔或走到死局时回到某个分叉，从那里走出新分支
+                if (rng() % 8 == 0 || !playRandomMove(*gameModel, model, rng))
+                {
+                    const SavedFork& fork = forks[rng() % forks.size()];
+                    fork.model.applyTo(*gameModel);
+                    model = fork.model.fork();
+                    ++branches;
+                }
+                else
+                {
+                    SavedFork saved = { model.fork(), model.getZobristHash(), model.getScore() };
+                    if (forks.size() < kMaxForks)
+                        forks.push_back(saved);
+                    else
+                        forks[rng() % forks.size()] = saved;
+                    ++moves;
+                }
+                consistent = sameState(*gameModel, model);
+            }
+            
+            // 分叉之间不共享可变状态：保存后的走法不应改动任何分叉
+            for (const SavedFork& fork : forks)
+            {
+                if (!consistent)
+                    break;
+                
+                fork.model.applyTo(*gameModel);
+                consistent = fork.model.getZobristHash() == fork.zobristHash && fork.model.getScore() == fork.score
+                    && sameState(*gameModel, fork.model);
+            }
+        }
+        
+        std::printf("  %4d + %4d cards %6d moves %6d branches   %s\n",
+                    playfieldCards, stackCards, moves, branches, consistent ? "ok" : "MISMATCH");
+        return consistent;
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: PersistentModelCheck [--playfield N --stack N] [--games N] [--steps N] [--seed N]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    CheckOptions options;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--playfield") == 0 && hasValue)
+        {
+            options.playfieldCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--stack") == 0 && hasValue)
+        {
+            options.stackCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--games") == 0 && hasValue)
+        {
+            options.games = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--steps") == 0 && hasValue)
+        {
+            options.steps = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+    
+    if (options.games < 1 || options.steps < 0 || (options.playfieldCards < 0) != (options.stackCards < 0))
+    {
+        printUsage();
+        return 2;
+    }
+    
+    std::printf("%d games, %d steps, seed %u\n", options.games, options.steps, options.seed);
+    bool consistent = true;
+    if (options.playfieldCards >= 0)
+    {
+        consistent = runLevel(options, options.playfieldCards, options.stackCards);
+    }
+    else
+    {
+        consistent = runLevel(options, 20, 10) && consistent;
+        consistent = runLevel(options, 700, 300) && consistent;
+    }
+    
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file main.cpp
+ * @brief 游戏存档保存/加载基准工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 生成随机关卡并随机走牌、撤销，得到带撤销历史的对局，然后反复保存到内存、从内存加载，
+ * 输出存档大小和保存、原地打开视图、完整加载（重建GameModel与UndoModel）的中位耗时，
+ * 并校验加载后的局面哈希、撤销步数与当前节点和保存前一致
+ * 只用到cocos2d的Vec2与日志，不创建窗口
+ *
+ * 用法：SnapshotBenchmark [--playfield N --stack N] [--actions N] [--iterations N] [--seed N]
+ *   不指定卡牌数时依次测试普通关卡（20+10张）和1000张卡牌的压力关卡（700+300张）
+ */
+
+#include "services/GameSnapshotService.h"
+#include "services/GameModelFromLevelGenerator.h"
+#include "managers/UndoManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        int playfieldCards = -1;
+        int stackCards = -1;
+        int actions = 2000;
+        int iterations = 200;
+        unsigned seed = 1;
+    };
+    
+    /**
+     * 生成随机关卡：卡牌分布范围随卡牌数增大，保持稀疏的覆盖关系
+     */
+    LevelConfig createRandomLevel(int playfieldCards, int stackCards, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> face(CFT_ACE, CFT_KING);
+        std::uniform_int_distribution<int> suit(CST_CLUBS, CST_SPADES);
+        std::uniform_real_distribution<float> coordinate(0.0f, 300.0f * std::sqrt(static_cast<float>(playfieldCards) + 1.0f));
+        
+        std::vector<LevelConfig::CardConfig> playfield;
+        for (int i = 0; i < playfieldCards; ++i)
+        {
+            playfield.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)),
+                                                        Vec2(coordinate(rng), coordinate(rng))));
+        }
+        
+        std::vector<LevelConfig::CardConfig> stack;
+        for (int i = 0; i < stackCards; ++i)
+        {
+            stack.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)), Vec2::ZERO));
+        }
+        
+        LevelConfig level;
+        level.setPlayfieldCards(playfield);
+        level.setStackCards(stack);
+        return level;
+    }
+    
+    /**
+     * 走一步随机的合法走法（与GameController相同：先记录再修改模型）
+     */
+    bool playRandomMove(GameModel& gameModel, UndoManager& undoManager, std::mt19937& rng)
+    {
+        GameMoveList moves;
+        gameModel.generateLegalMoves(moves);
+        if (moves.count == 0)
+            return false;
+        
+        const GameMove& move = moves.moves[rng() % moves.count];
+        int trayCardId = gameModel.getTrayCardId();
+        int cardId;
+        if (move.type == GMT_MATCH)
+        {
+            cardId = move.bit;
+            undoManager.recordMoveAction(cardId, trayCardId);
+            gameModel.removePlayfieldCard(cardId);
+            gameModel.addScore(10);
+        }
+        else
+        {
+            cardId = gameModel.getTopStackCard()->getCardId();
+            undoManager.recordStackToTrayAction(cardId, trayCardId);
+            gameModel.popStackCard();
+        }
+        gameModel.getCard(cardId)->setPosition(gameModel.getTrayPosition());
+        gameModel.setTrayCard(cardId);
+        return true;
+    }
+    
+    double median(std::vector<double>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+    
+    double elapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * 对一种关卡规模计时
+     * @return 加载结果与保存前不一致时返回false
+     */
+    bool runLevel(const BenchmarkOptions& options, int playfieldCards, int stackCards)
+    {
+        std::mt19937 rng(options.seed);
+        LevelConfig level = createRandomLevel(playfieldCards, stackCards, rng);
+        std::unique_ptr<GameModel> gameModel(GameModelFromLevelGenerator::generateGameModel(level));
+        
+        UndoModel undoModel;
+        UndoManager undoManager;
+        undoManager.init(&undoModel, gameModel.get());
+        for (int i = 0; i < options.actions; ++i)
+        {
+            if (rng() % 8 == 0 || !playRandomMove(*gameModel, undoManager, rng))
+            {
+                undoManager.undoSteps(1 + rng() % 8);
+            }
+        }
+        
+        std::vector<uint8_t> buffer;
+        std::vector<double> saveUs, openUs, loadUs;
+        bool consistent = true;
+        for (int i = 0; i < options.iterations; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            GameSnapshotService::save(*gameModel, &undoModel, buffer);
+            saveUs.push_back(elapsedUs(start));
+            
+            start = std::chrono::steady_clock::now();
+            GameSnapshotView view;
+            bool opened = view.open(buffer.data(), buffer.size());
+            openUs.push_back(elapsedUs(start));
+            
+            UndoModel loadedUndo;
+            start = std::chrono::steady_clock::now();
+            std::unique_ptr<GameModel> loaded(opened ? GameSnapshotService::load(view, &loadedUndo) : nullptr);
+            loadUs.push_back(elapsedUs(start));
+            
+            consistent = consistent && loaded
+                && loaded->getZobristHash() == gameModel->getZobristHash()
+                && loaded->getScore() == gameModel->getScore()
+                && loadedUndo.getCurrentNode() == undoModel.getCurrentNode()
+                && loadedUndo.getUndoCount() == undoModel.getUndoCount()
+                && loadedUndo.getNodeCount() == undoModel.getNodeCount();
+        }
+        
+        std::printf("  %4d + %4d cards %6zu history nodes  %8.1f KB   save %8.2f us   open %6.2f us   load %8.2f us   %s\n",
+                    playfieldCards, stackCards, undoModel.getNodeCount(), buffer.size() / 1024.0,
+                    median(saveUs), median(openUs), median(loadUs), consistent ? "ok" : "MISMATCH");
+        return consistent;
+    }
+    
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: SnapshotBenchmark [--playfield N --stack N] [--actions N] [--iterations N] [--seed N]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--playfield") == 0 && hasValue)
+        {
+            options.playfieldCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--stack") == 0 && hasValue)
+        {
+            options.stackCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--actions") == 0 && hasValue)
+        {
+            options.actions = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0 && hasValue)
+        {
+            options.iterations = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+    
+    if (options.iterations < 1 || (options.playfieldCards < 0) != (options.stackCards < 0)
+        || options.playfieldCards + options.stackCards > UndoAction::kMaxCardId)
+    {
+        printUsage();
+        return 2;
+    }
+    
+    std::printf("%d actions, %d iterations, seed %u\n", options.actions, options.iterations, options.seed);
+    bool consistent = true;
+    if (options.playfieldCards >= 0)
+    {
+        consistent = runLevel(options, options.playfieldCards, options.stackCards);
+    }
+    else
+    {
+        consistent = runLevel(options, 20, 10) && consistent;
+        consistent = runLevel(options, 700, 300) && consistent;
+    }
+    
+    return consistent ? 0 : 1;
+}
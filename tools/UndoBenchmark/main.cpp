@@ -0,0 +1,237 @@
+/**
+ * @file main.cpp
+ * @brief 撤销历史快照间隔基准工具
+ * @author OUC-Zhou Tao
+ * @date 2024
+ *
+ * 生成一局较大的随机关卡，随机走牌、批量撤销并走出新分支，得到一棵较深的撤销历史树；
+ * 再用不同的快照间隔K重建同一棵历史树（随机种子相同），比较：
+ * - 节点池与快照池的内存占用
+ * - 跳转到随机历史节点的平均耗时
+ * - 从当前局面回退到随机步数（"从第k步重新开始"）的平均耗时
+ * 只用到cocos2d的Vec2与日志，不创建窗口
+ *
+ * 用法：UndoBenchmark [--playfield N] [--stack N] [--actions N] [--jumps N] [--seed N] [--interval K ...]
+ *   --interval K  要比较的快照间隔，可重复；0表示不保存快照，默认比较0、2、4、8、16、32、64
+ */
+
+#include "managers/UndoManager.h"
+#include "services/GameModelFromLevelGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        int playfieldCards = 256;
+        int stackCards = 256;
+        int actions = 4000;
+        int jumps = 2000;
+        unsigned seed = 1;
+        std::vector<int> intervals;
+    };
+
+    /**
+     * 生成随机关卡：游戏区卡牌分布在较大的范围内，覆盖关系稀疏，保证能走出足够深的历史
+     */
+    LevelConfig createRandomLevel(const BenchmarkOptions& options, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> face(CFT_ACE, CFT_KING);
+        std::uniform_int_distribution<int> suit(CST_CLUBS, CST_SPADES);
+        std::uniform_real_distribution<float> coordinate(0.0f, 6000.0f);
+
+        std::vector<LevelConfig::CardConfig> playfield;
+        for (int i = 0; i < options.playfieldCards; ++i)
+        {
+            playfield.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)),
+                                                        Vec2(coordinate(rng), coordinate(rng))));
+        }
+
+        std::vector<LevelConfig::CardConfig> stack;
+        for (int i = 0; i < options.stackCards; ++i)
+        {
+            stack.push_back(LevelConfig::CardConfig(static_cast<CardFaceType>(face(rng)), static_cast<CardSuitType>(suit(rng)), Vec2::ZERO));
+        }
+
+        LevelConfig level;
+        level.setPlayfieldCards(playfield);
+        level.setStackCards(stack);
+        return level;
+    }
+
+    /**
+     * 走一步随机的合法走法（与GameController相同：先记录再修改模型）
+     * @return 没有合法走法时返回false
+     */
+    bool playRandomMove(GameModel& gameModel, UndoManager& undoManager, std::mt19937& rng)
+    {
+        GameMoveList moves;
+        gameModel.generateLegalMoves(moves);
+        if (moves.count == 0)
+            return false;
+
+        const GameMove& move = moves.moves[rng() % moves.count];
+        int trayCardId = gameModel.getTrayCardId();
+        int cardId;
+        if (move.type == GMT_MATCH)
+        {
+            cardId = move.bit;
+            undoManager.recordMoveAction(cardId, trayCardId);
+            gameModel.removePlayfieldCard(cardId);
+        }
+        else
+        {
+            cardId = gameModel.getTopStackCard()->getCardId();
+            undoManager.recordStackToTrayAction(cardId, trayCardId);
+            gameModel.popStackCard();
+        }
+        gameModel.getCard(cardId)->setPosition(gameModel.getTrayPosition());
+        gameModel.setTrayCard(cardId);
+        return true;
+    }
+
+    double elapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * 用指定快照间隔重建历史树并计时
+     */
+    void runInterval(const BenchmarkOptions& options, int interval)
+    {
+        std::mt19937 rng(options.seed);
+        LevelConfig level = createRandomLevel(options, rng);
+        std::unique_ptr<GameModel> gameModel(GameModelFromLevelGenerator::generateGameModel(level));
+
+        UndoModel undoModel;
+        undoModel.setSnapshotInterval(interval);
+        UndoManager undoManager;
+        undoManager.init(&undoModel, gameModel.get());
+
+        // 大部分时间向前走，偶尔回退几步后走出新分支；走不动时回退得更多
+        std::vector<int> visited;
+        for (int i = 0; i < options.actions; ++i)
+        {
+            if (rng() % 8 == 0 || !playRandomMove(*gameModel, undoManager, rng))
+            {
+                undoManager.undoSteps(1 + rng() % 16);
+            }
+            visited.push_back(undoManager.getCurrentNode());
+        }
+
+        // 历史树中所有走到过的节点（节点预算不限，不会被淘汰）
+        std::sort(visited.begin(), visited.end());
+        visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+        std::vector<int> nodes;
+        int maxDepth = 0;
+        for (int node : visited)
+        {
+            if (undoModel.isNodeValid(node))
+            {
+                nodes.push_back(node);
+                maxDepth = std::max(maxDepth, undoModel.getNodeDepth(node));
+            }
+        }
+
+        // 跳转到随机历史节点
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.jumps; ++i)
+        {
+            undoManager.jumpToNode(nodes[rng() % nodes.size()]);
+        }
+        double jumpUs = elapsedUs(start) / options.jumps;
+
+        // 回退到当前路径上的随机步数，再跳回原处
+        double rewindUs = 0.0;
+        for (int i = 0; i < options.jumps; ++i)
+        {
+            int from = undoManager.getCurrentNode();
+            size_t steps = undoManager.getUndoCount() > 0 ? 1 + rng() % undoManager.getUndoCount() : 0;
+
+            start = std::chrono::steady_clock::now();
+            undoManager.undoSteps(steps);
+            rewindUs += elapsedUs(start);
+
+            undoManager.jumpToNode(from);
+        }
+        rewindUs /= options.jumps;
+
+        std::printf("  K=%-3d %6zu nodes  depth %4d  %5zu snapshots %9.1f KB   jump %8.2f us   rewind %8.2f us\n",
+                    interval, undoModel.getNodeCount(), maxDepth, undoModel.getSnapshotCount(),
+                    undoModel.getMemoryUsage() / 1024.0, jumpUs, rewindUs);
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr, "usage: UndoBenchmark [--playfield N] [--stack N] [--actions N] [--jumps N] [--seed N] [--interval K ...]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--playfield") == 0 && hasValue)
+        {
+            options.playfieldCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--stack") == 0 && hasValue)
+        {
+            options.stackCards = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--actions") == 0 && hasValue)
+        {
+            options.actions = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--jumps") == 0 && hasValue)
+        {
+            options.jumps = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--interval") == 0 && hasValue)
+        {
+            options.intervals.push_back(std::atoi(argv[++i]));
+        }
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (options.playfieldCards < 0 || options.stackCards < 1 || options.jumps < 1
+        || options.playfieldCards + options.stackCards > UndoAction::kMaxCardId)
+    {
+        printUsage();
+        return 2;
+    }
+    if (options.intervals.empty())
+    {
+        options.intervals = { 0, 2, 4, 8, 16, 32, 64 };
+    }
+
+    std::printf("%d playfield + %d stack cards, %d actions, %d jumps, seed %u\n",
+                options.playfieldCards, options.stackCards, options.actions, options.jumps, options.seed);
+    for (int interval : options.intervals)
+    {
+        runInterval(options, interval);
+    }
+
+    return 0;
+}